@@ -0,0 +1,86 @@
+#include "adjacency.h"
+#include <algorithm>
+#include <cassert>
+
+template<typename NodeId>
+Adjacency<NodeId> buildAdjacency(const std::vector<std::vector<std::pair<NodeId, NodeId>>> &a_Chunks,
+                                 const uint64_t a_NrOfNodes, const bool a_ByTarget, ThreadPool &a_ThreadPool) {
+    assert(a_NrOfNodes > 0);
+    const auto get_key = [a_ByTarget](const std::pair<NodeId, NodeId> &a_Edge) {
+        return static_cast<uint64_t>(a_ByTarget ? a_Edge.second : a_Edge.first);
+    };
+    // Several buckets per thread, so that buckets of uneven size still balance out.
+    constexpr size_t buckets_per_thread = 4;
+    const size_t nr_chunks = a_Chunks.size();
+    const uint64_t max_buckets = std::min<uint64_t>(a_ThreadPool.getNrOfThreads() * buckets_per_thread, a_NrOfNodes);
+    const uint64_t nodes_per_bucket = (a_NrOfNodes + max_buckets - 1) / max_buckets;
+    // Rounding up the bucket size may leave fewer buckets than asked for, and every bucket must hold a node.
+    const auto nr_buckets = static_cast<size_t>((a_NrOfNodes + nodes_per_bucket - 1) / nodes_per_bucket);
+
+    // Count the edges of every chunk per bucket.
+    std::vector<std::vector<uint64_t>> positions(nr_chunks, std::vector<uint64_t>(nr_buckets, 0));
+    a_ThreadPool.parallelFor(nr_chunks, [&a_Chunks, &positions, &get_key, nodes_per_bucket](const size_t a_Chunk) {
+        for (const auto &edge : a_Chunks[a_Chunk]) {
+            ++positions[a_Chunk][get_key(edge) / nodes_per_bucket];
+        }
+    });
+    // Turn the counts into the position of every chunk within every bucket, buckets first.
+    std::vector<uint64_t> bucket_offsets(nr_buckets + 1, 0);
+    uint64_t position = 0;
+    for (size_t bucket = 0; bucket < nr_buckets; ++bucket) {
+        bucket_offsets[bucket] = position;
+        for (size_t chunk = 0; chunk < nr_chunks; ++chunk) {
+            const uint64_t count = positions[chunk][bucket];
+            positions[chunk][bucket] = position;
+            position += count;
+        }
+    }
+    bucket_offsets[nr_buckets] = position;
+
+    std::vector<std::pair<NodeId, NodeId>> bucketed(position);
+    a_ThreadPool.parallelFor(nr_chunks, [&a_Chunks, &positions, &bucketed, &get_key, nodes_per_bucket](
+            const size_t a_Chunk) {
+        auto &chunk_positions = positions[a_Chunk];
+        for (const auto &edge : a_Chunks[a_Chunk]) {
+            bucketed[chunk_positions[get_key(edge) / nodes_per_bucket]++] = edge;
+        }
+    });
+    std::vector<std::vector<uint64_t>>().swap(positions);
+
+    // Every bucket owns a range of nodes and a range of edges, so the buckets are placed independently.
+    Adjacency<NodeId> adjacency;
+    adjacency.m_Offsets.assign(a_NrOfNodes + 1, 0);
+    adjacency.m_Neighbours.resize(position);
+    a_ThreadPool.parallelFor(nr_buckets, [&adjacency, &bucketed, &bucket_offsets, &get_key, a_ByTarget,
+            a_NrOfNodes, nodes_per_bucket](const size_t a_Bucket) {
+        const uint64_t first_node = a_Bucket * nodes_per_bucket;
+        const uint64_t last_node = std::min(first_node + nodes_per_bucket, a_NrOfNodes);
+        assert(first_node < last_node);
+        const auto begin = bucketed.begin() + static_cast<std::ptrdiff_t>(bucket_offsets[a_Bucket]);
+        const auto end = bucketed.begin() + static_cast<std::ptrdiff_t>(bucket_offsets[a_Bucket + 1]);
+        std::vector<uint64_t> cursors(last_node - first_node, 0);
+        for (auto edge = begin; edge != end; ++edge) {
+            ++cursors[get_key(*edge) - first_node];
+        }
+        uint64_t offset = bucket_offsets[a_Bucket];
+        for (uint64_t i = 0; i < cursors.size(); ++i) {
+            const uint64_t degree = cursors[i];
+            cursors[i] = offset;
+            offset += degree;
+            adjacency.m_Offsets[first_node + i + 1] = offset;
+        }
+        for (auto edge = begin; edge != end; ++edge) {
+            adjacency.m_Neighbours[cursors[get_key(*edge) - first_node]++] = a_ByTarget ? edge->first
+                                                                                       : edge->second;
+        }
+    });
+    return adjacency;
+}
+
+template Adjacency<uint32_t>
+buildAdjacency(const std::vector<std::vector<std::pair<uint32_t, uint32_t>>> &a_Chunks, const uint64_t a_NrOfNodes,
+               const bool a_ByTarget, ThreadPool &a_ThreadPool);
+
+template Adjacency<uint64_t>
+buildAdjacency(const std::vector<std::vector<std::pair<uint64_t, uint64_t>>> &a_Chunks, const uint64_t a_NrOfNodes,
+               const bool a_ByTarget, ThreadPool &a_ThreadPool);
@@ -0,0 +1,25 @@
+#ifndef GMARK_ADJACENCY_H
+#define GMARK_ADJACENCY_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+
+// Compressed sparse row form of a set of edges: the neighbours of node v are
+// m_Neighbours[m_Offsets[v]] up to m_Neighbours[m_Offsets[v + 1]].
+template<typename NodeId>
+struct Adjacency {
+    std::vector<uint64_t> m_Offsets;
+    std::vector<NodeId> m_Neighbours;
+};
+
+// Builds the adjacency of the (source, target) edges in a_Chunks over the nodes [0, a_NrOfNodes), keyed by the
+// source or, with a_ByTarget, by the target. The placement is stable, so the neighbours of every node keep the order
+// of the chunks. The edges are first scattered into buckets of node ranges with a radix pass over the chunks, after
+// which every bucket is placed by counting its degrees. Both passes run in parallel without a comparison sort.
+template<typename NodeId>
+Adjacency<NodeId> buildAdjacency(const std::vector<std::vector<std::pair<NodeId, NodeId>>> &a_Chunks,
+                                 const uint64_t a_NrOfNodes, const bool a_ByTarget, ThreadPool &a_ThreadPool);
+
+#endif //GMARK_ADJACENCY_H
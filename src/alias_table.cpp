@@ -0,0 +1,53 @@
+#include "alias_table.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+AliasTable::AliasTable(const std::vector<double> &a_Weights) {
+    if (a_Weights.empty() || a_Weights.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("An alias table needs between 1 and 2^32 - 1 weights.");
+    }
+    double total_weight = 0.0;
+    for (const double weight : a_Weights) {
+        if (!(weight >= 0.0) || !std::isfinite(weight)) {
+            throw std::invalid_argument("The weights of an alias table must be finite and non-negative.");
+        }
+        total_weight += weight;
+    }
+    if (total_weight <= 0.0) {
+        throw std::invalid_argument("The weights of an alias table must have a positive sum.");
+    }
+
+    // Scale the weights so that the average column is exactly full, then let every column that is too empty take
+    // the rest of its share from a column that is too full.
+    const auto nr_columns = static_cast<uint32_t>(a_Weights.size());
+    std::vector<double> shares(nr_columns);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < nr_columns; ++i) {
+        shares[i] = a_Weights[i] * static_cast<double>(nr_columns) / total_weight;
+        (shares[i] < 1.0 ? small : large).push_back(i);
+    }
+    // 2^64, the scale of the thresholds.
+    constexpr double threshold_scale = 18446744073709551616.0;
+    m_Columns.assign(nr_columns, {std::numeric_limits<uint64_t>::max(), 0});
+    for (uint32_t i = 0; i < nr_columns; ++i) {
+        m_Columns[i].m_Alias = i;
+    }
+    while (!small.empty() && !large.empty()) {
+        const uint32_t less = small.back();
+        small.pop_back();
+        const uint32_t more = large.back();
+        // Rounding errors can push the share of a column that was just moved to the small ones below zero.
+        m_Columns[less].m_Threshold = static_cast<uint64_t>(std::max(shares[less], 0.0) * threshold_scale);
+        m_Columns[less].m_Alias = more;
+        // Subtracting after the addition keeps the rounding error of the shares small.
+        shares[more] = (shares[more] + shares[less]) - 1.0;
+        if (shares[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // What is left is full up to rounding errors, and those columns keep their defaults.
+}
@@ -0,0 +1,38 @@
+#ifndef GMARK_ALIAS_TABLE_H
+#define GMARK_ALIAS_TABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "random_stream.h"
+
+// Draws indices with probabilities proportional to their weights in O(1) with Walker's alias method. Every index
+// owns a column that keeps the index itself with the column's threshold probability and hands the rest of its
+// share to an alias. A draw picks a column uniformly at random and then compares a second value to the threshold.
+// The table is built with Vose's algorithm in O(n). The threshold and the alias of a column are stored side by
+// side, so a draw touches a single cache line.
+class AliasTable {
+private:
+    struct Column {
+        // The column keeps its own index when the next value is below the threshold, which is the probability
+        // scaled to 2^64. Full columns are their own alias.
+        uint64_t m_Threshold;
+        uint32_t m_Alias;
+    };
+
+    std::vector<Column> m_Columns;
+
+public:
+    // The weights must be non-negative with a positive sum, and there must be fewer than 2^32 of them.
+    explicit AliasTable(const std::vector<double> &a_Weights);
+
+    size_t size() const {
+        return m_Columns.size();
+    }
+
+    uint32_t sample(RandomStream &a_Generator) const {
+        const uint32_t column = a_Generator.getBoundedInteger(static_cast<uint32_t>(m_Columns.size()));
+        return a_Generator() < m_Columns[column].m_Threshold ? column : m_Columns[column].m_Alias;
+    }
+};
+
+#endif //GMARK_ALIAS_TABLE_H
@@ -6,7 +6,11 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
-#include <codecvt>
+#include <charconv>
+#include <cmath>
+#include <vector>
+#include "alias_table.h"
+#include "civil_date.h"
 #include "random_distribution.h"
 #include "regex_parser/sre_parse.h"
 #include "regex_parser/branch.h"
@@ -15,14 +19,62 @@
 #include "regex_parser/min_repeat.h"
 #include "regex_parser/max_repeat.h"
 #include "random_string_generator.h"
+#include "string_pool.h"
 #include <regex>
 
+// The values of a batch of nodes, stored back to back in one string. The memory is kept when the values are
+// cleared, so refilling them does not allocate once they have grown to the size of a batch. The same holds for the
+// scratch space that attributes use while they generate a batch.
+class AttributeValues {
+private:
+    std::string m_Data;
+    std::vector<size_t> m_Ends;
+    std::vector<double> m_Numbers;
+    RandomStringGenerator::RealizedGroups m_Groups;
+
+public:
+    // Attributes append the bytes of a value to the data and then end the value.
+    std::string &getData() {
+        return m_Data;
+    }
+
+    void endValue() {
+        m_Ends.push_back(m_Data.size());
+    }
+
+    void clear() {
+        m_Data.clear();
+        m_Ends.clear();
+    }
+
+    size_t getCount() const {
+        return m_Ends.size();
+    }
+
+    const char *getValue(const size_t a_Index) const {
+        return m_Data.data() + (a_Index == 0 ? 0 : m_Ends[a_Index - 1]);
+    }
+
+    size_t getLength(const size_t a_Index) const {
+        return m_Ends[a_Index] - (a_Index == 0 ? 0 : m_Ends[a_Index - 1]);
+    }
+
+    // Scratch space for the numbers of a batch.
+    std::vector<double> &getNumbers() {
+        return m_Numbers;
+    }
+
+    // Scratch space for the groups of a regular expression.
+    RandomStringGenerator::RealizedGroups &getGroups() {
+        return m_Groups;
+    }
+};
+
 class Attribute {
 protected:
     const std::string m_Name;
     bool m_Required;
     bool m_Unique;
-    std::mt19937 m_Generator{std::random_device{}()};
 public:
     Attribute(std::string a_Name, const bool a_Required, const bool a_Unique) :
             m_Name(std::move(a_Name)),
@@ -31,13 +83,38 @@ public:
         assert(!m_Name.empty());
     }
 
-    virtual std::string getRandomAttribute() = 0;
+    // Appends the bytes of a random value to a_Value. Attributes are shared by the threads that generate the
+    // attribute values, so drawing a value must not change the attribute.
+    virtual void appendRandomAttribute(RandomStream &a_Generator, std::string &a_Value) const = 0;
+
+    // Adds a_Count values to a_Values, which are the same as a_Count consecutive single values. Attributes that
+    // are backed by a distribution draw all numbers of the batch at once. Unique attributes instead derive the
+    // values from their indices, starting at a_FirstIndex, and from a_UniqueStream, which must be the same for all
+    // batches of the attribute.
+    virtual void appendRandomAttributes(RandomStream &a_Generator, const RandomStream &a_UniqueStream,
+                                        const uint64_t a_FirstIndex, const size_t a_Count,
+                                        AttributeValues &a_Values) const {
+        for (size_t i = 0; i < a_Count; ++i) {
+            appendRandomAttribute(a_Generator, a_Values.getData());
+            a_Values.endValue();
+        }
+    }
+
+    // Whether the first a_NrOfValues values of appendRandomAttributes are distinct by construction, in which case a
+    // unique attribute needs no check for repeated values.
+    virtual bool hasDistinctValues(const uint64_t a_NrOfValues) const {
+        return false;
+    }
 
     virtual ~Attribute() = 0;
 
     const std::string &getName() const {
         return m_Name;
     }
+
+    bool isUnique() const {
+        return m_Unique;
+    }
 };
 
 class NumericAttribute : public Attribute {
@@ -46,12 +123,55 @@ protected:
     double m_Max;
     int m_Precision;
     std::unique_ptr<RandomDistribution> m_Distribution;
-    std::stringstream m_Stream;
 
-    double getRandomNumber() {
-        double random_value = m_Distribution->getRandomDouble();
+    double getRandomNumber(RandomStream &a_Generator) const {
+        double random_value = m_Distribution->getRandomDouble(a_Generator);
         return std::clamp(random_value, m_Min, m_Max);
     }
+
+    // Replaces the contents of a_Numbers by a_Count clamped random numbers.
+    void getRandomNumbers(RandomStream &a_Generator, const RandomStream &a_UniqueStream, const uint64_t a_FirstIndex,
+                          const size_t a_Count, std::vector<double> &a_Numbers) const {
+        a_Numbers.resize(a_Count);
+        if (m_Unique && m_Distribution->isUnique()) {
+            m_Distribution->getUniqueDoubles(a_UniqueStream, a_FirstIndex, a_Numbers.data(), a_Count);
+        } else {
+            m_Distribution->getRandomDoubles(a_Generator, a_Numbers.data(), a_Count);
+        }
+        for (auto &random_value : a_Numbers) {
+            random_value = std::clamp(random_value, m_Min, m_Max);
+        }
+    }
+
+    // Formats like a stream with std::fixed and std::setprecision(m_Precision) would. std::to_chars rounds the exact
+    // binary value correctly, as printf does, but does not depend on the locale and is several times faster.
+    void appendNumber(const double a_Number, std::string &a_Value) const {
+        // Whole numbers without decimals, which includes every value of an integer distribution, are formatted as
+        // integers. Negative zero is left to std::to_chars, which keeps the sign.
+        constexpr double integer_limit = 9223372036854775808.0; // 2^63
+        if (m_Precision == 0 && !std::islessgreater(std::trunc(a_Number), a_Number) &&
+            std::abs(a_Number) < integer_limit && !(std::fpclassify(a_Number) == FP_ZERO && std::signbit(a_Number))) {
+            char buffer[std::numeric_limits<int64_t>::digits10 + 2];
+            const auto result = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<int64_t>(a_Number));
+            a_Value.append(buffer, static_cast<size_t>(result.ptr - buffer));
+            return;
+        }
+        char buffer[64];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), a_Number, std::chars_format::fixed,
+                                          m_Precision);
+        if (result.ec == std::errc()) {
+            a_Value.append(buffer, static_cast<size_t>(result.ptr - buffer));
+            return;
+        }
+        // Huge numbers or precisions are formatted into the value directly. The sign, the 309 digits of the
+        // largest double and the decimal point bound the length.
+        const size_t start = a_Value.size();
+        a_Value.resize(start + std::numeric_limits<double>::max_exponent10 + 3 + static_cast<size_t>(m_Precision));
+        const auto large_result = std::to_chars(&a_Value[start], &a_Value[0] + a_Value.size(), a_Number,
+                                                std::chars_format::fixed, m_Precision);
+        assert(large_result.ec == std::errc());
+        a_Value.resize(static_cast<size_t>(large_result.ptr - a_Value.data()));
+    }
 public:
     NumericAttribute(const std::string &a_Name, bool a_Required, bool a_Unique, double a_Min, double a_Max, int a_Precision,
                      std::unique_ptr<RandomDistribution> a_Distribution) :
@@ -62,52 +182,104 @@ public:
             m_Distribution(std::move(a_Distribution)) {
         assert(m_Min <= m_Max);
         assert(m_Precision >= 0);
-        m_Stream << std::fixed << std::setprecision(m_Precision);
     }
 
-    std::string getRandomAttribute() override {
-        m_Stream.str(std::string());
-        m_Stream << getRandomNumber();
-        return m_Stream.str();
+    void appendRandomAttribute(RandomStream &a_Generator, std::string &a_Value) const override {
+        appendNumber(getRandomNumber(a_Generator), a_Value);
+    }
+
+    bool hasDistinctValues(const uint64_t a_NrOfValues) const override {
+        return m_Unique && m_Distribution->isUnique() &&
+               m_Distribution->hasDistinctDoubles(a_NrOfValues, m_Min, m_Max);
+    }
+
+    void appendRandomAttributes(RandomStream &a_Generator, const RandomStream &a_UniqueStream,
+                                const uint64_t a_FirstIndex, const size_t a_Count,
+                                AttributeValues &a_Values) const override {
+        auto &random_values = a_Values.getNumbers();
+        getRandomNumbers(a_Generator, a_UniqueStream, a_FirstIndex, a_Count, random_values);
+        for (const double random_value : random_values) {
+            appendNumber(random_value, a_Values.getData());
+            a_Values.endValue();
+        }
     }
 };
 
 class DateAttribute : public NumericAttribute {
 protected:
-    char buffer[11] = {0};
+    // Writes the UTC date of a_Date seconds since the epoch as YYYY-MM-DD, with a sign and more digits for years
+    // outside [0, 9999].
+    void appendDate(const double a_Date, std::string &a_Value) const {
+        constexpr int64_t seconds_per_day = 86400;
+        // Beyond 2^62 seconds the years no longer fit the calendar arithmetic.
+        constexpr double limit = 4611686018427387904.0;
+        const auto seconds = static_cast<int64_t>(std::clamp(a_Date, -limit, limit));
+        const int64_t days = seconds / seconds_per_day - (seconds % seconds_per_day < 0 ? 1 : 0);
+        const CivilDate date = civilFromDays(days);
+        char buffer[std::numeric_limits<int64_t>::digits10 + 8];
+        char *end = buffer;
+        if (date.m_Year >= 0 && date.m_Year <= 9999) {
+            const auto year = static_cast<unsigned int>(date.m_Year);
+            *end++ = static_cast<char>('0' + year / 1000);
+            *end++ = static_cast<char>('0' + year / 100 % 10);
+            *end++ = static_cast<char>('0' + year / 10 % 10);
+            *end++ = static_cast<char>('0' + year % 10);
+        } else {
+            end = std::to_chars(end, buffer + sizeof(buffer), date.m_Year).ptr;
+        }
+        *end++ = '-';
+        *end++ = static_cast<char>('0' + date.m_Month / 10);
+        *end++ = static_cast<char>('0' + date.m_Month % 10);
+        *end++ = '-';
+        *end++ = static_cast<char>('0' + date.m_Day / 10);
+        *end++ = static_cast<char>('0' + date.m_Day % 10);
+        a_Value.append(buffer, static_cast<size_t>(end - buffer));
+    }
+
 public:
     DateAttribute(const std::string &a_Name, bool a_Required, bool a_Unique, double a_Min, double a_Max, int a_Precision,
                   std::unique_ptr<RandomDistribution> a_Distribution) :
               NumericAttribute(a_Name, a_Required, a_Unique, a_Min, a_Max, a_Precision, std::move(a_Distribution)) {}
 
-    std::string getRandomAttribute() override {
-        auto date = static_cast<std::time_t>(NumericAttribute::getRandomNumber());
-        std::tm* date_tm = std::localtime(&date);
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d", date_tm);
-        return std::string(buffer);
+    void appendRandomAttribute(RandomStream &a_Generator, std::string &a_Value) const override {
+        appendDate(NumericAttribute::getRandomNumber(a_Generator), a_Value);
+    }
+
+    bool hasDistinctValues(const uint64_t a_NrOfValues) const override {
+        // Distinct seconds can fall on the same day.
+        return false;
+    }
+
+    void appendRandomAttributes(RandomStream &a_Generator, const RandomStream &a_UniqueStream,
+                                const uint64_t a_FirstIndex, const size_t a_Count,
+                                AttributeValues &a_Values) const override {
+        auto &random_values = a_Values.getNumbers();
+        getRandomNumbers(a_Generator, a_UniqueStream, a_FirstIndex, a_Count, random_values);
+        for (const double random_value : random_values) {
+            appendDate(random_value, a_Values.getData());
+            a_Values.endValue();
+        }
     }
 };
 
 class CategoricalAttribute : public Attribute {
 protected:
-    std::uniform_real_distribution<double> m_Distribution;
-    std::map<double, std::string> m_Categories;
+    StringPool m_Categories;
+    AliasTable m_AliasTable;
+
 public:
-    CategoricalAttribute(const std::string &a_Name, bool a_Required, bool a_Unique,
-                         const std::map<std::string, double> &a_Categories)
-            : Attribute(a_Name, a_Required, a_Unique) {
-        double sum = 0.0;
-        for (const auto &category : a_Categories) {
-            assert(category.second > 0.0);
-            sum += category.second;
-            m_Categories[sum] = category.first;
-        }
-        m_Distribution = std::uniform_real_distribution<double>(0.0, sum);
+    // a_Probabilities holds the probability of every category in the pool, in the order of the pool.
+    CategoricalAttribute(const std::string &a_Name, bool a_Required, bool a_Unique, StringPool a_Categories,
+                         const std::vector<double> &a_Probabilities)
+            : Attribute(a_Name, a_Required, a_Unique),
+              m_Categories(std::move(a_Categories)),
+              m_AliasTable(a_Probabilities) {
+        assert(m_Categories.size() == m_AliasTable.size());
     }
 
-    std::string getRandomAttribute() override {
-        double random_value = m_Distribution(m_Generator);
-        return m_Categories.lower_bound(random_value)->second;
+    void appendRandomAttribute(RandomStream &a_Generator, std::string &a_Value) const override {
+        const uint32_t category = m_AliasTable.sample(a_Generator);
+        a_Value.append(m_Categories.getData(category), m_Categories.getLength(category));
     }
 };
 
@@ -121,26 +293,40 @@ public:
 
     }
 
-    std::string getRandomAttribute() override {
-        return m_StringGenerator.getRandomString();
+    void appendRandomAttribute(RandomStream &a_Generator, std::string &a_Value) const override {
+        // Single values have no caller-owned scratch space, so every thread keeps its groups from one value to the
+        // next.
+        thread_local RandomStringGenerator::RealizedGroups realized_groups;
+        m_StringGenerator.appendRandomString(a_Generator, a_Value, realized_groups);
     }
 
+    void appendRandomAttributes(RandomStream &a_Generator, const RandomStream &a_UniqueStream,
+                                const uint64_t a_FirstIndex, const size_t a_Count,
+                                AttributeValues &a_Values) const override {
+        auto &realized_groups = a_Values.getGroups();
+        for (size_t i = 0; i < a_Count; ++i) {
+            m_StringGenerator.appendRandomString(a_Generator, a_Values.getData(), realized_groups);
+            a_Values.endValue();
+        }
+    }
 };
 
 class ChoiceAttribute : public Attribute {
 protected:
-    std::uniform_real_distribution<double> m_Distribution;
-    std::map<double, std::unique_ptr<Attribute>> m_Choices;
+    std::vector<std::unique_ptr<Attribute>> m_Choices;
+    AliasTable m_AliasTable;
 public:
+    // a_Probabilities holds the probability of every choice, in the same order.
     ChoiceAttribute(const std::string &a_Name, bool a_Required, bool a_Unique,
-                    std::map<double, std::unique_ptr<Attribute>> a_Choices, double a_CumulativeProbability)
+                    std::vector<std::unique_ptr<Attribute>> a_Choices, const std::vector<double> &a_Probabilities)
             : Attribute(a_Name, a_Required, a_Unique),
-              m_Distribution(std::uniform_real_distribution<double>(0.0, a_CumulativeProbability)),
-              m_Choices(std::move(a_Choices)) {}
+              m_Choices(std::move(a_Choices)),
+              m_AliasTable(a_Probabilities) {
+        assert(m_Choices.size() == m_AliasTable.size());
+    }
 
-    std::string getRandomAttribute() override {
-        double random_value = m_Distribution(m_Generator);
-        return m_Choices.lower_bound(random_value)->second->getRandomAttribute();
+    void appendRandomAttribute(RandomStream &a_Generator, std::string &a_Value) const override {
+        m_Choices[m_AliasTable.sample(a_Generator)]->appendRandomAttribute(a_Generator, a_Value);
     }
 };
 
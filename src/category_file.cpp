@@ -0,0 +1,152 @@
+#include "category_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t CategoryFile::m_MinChunkSize = 1U << 24U;
+
+CategoryFile::CategoryFile(const std::string &a_FileName) {
+    const int file_descriptor = open(a_FileName.c_str(), O_RDONLY);
+    if (file_descriptor == -1) {
+        throw std::invalid_argument("Cannot open category file.");
+    }
+    struct stat status{};
+    if (fstat(file_descriptor, &status) == -1 || !S_ISREG(status.st_mode)) {
+        close(file_descriptor);
+        throw std::invalid_argument("Category file " + a_FileName + " is not a regular file.");
+    }
+    m_Size = static_cast<size_t>(status.st_size);
+    if (m_Size > 0) {
+        void *data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if (data == MAP_FAILED) {
+            const int error = errno;
+            close(file_descriptor);
+            throw std::invalid_argument("Cannot map category file " + a_FileName + ": " + std::strerror(error));
+        }
+        // The file is read front to back once.
+        madvise(data, m_Size, MADV_SEQUENTIAL);
+        m_Data = static_cast<const char *>(data);
+    }
+    // The mapping stays valid after the file is closed.
+    close(file_descriptor);
+}
+
+CategoryFile::~CategoryFile() {
+    if (m_Data != nullptr) {
+        munmap(const_cast<char *>(m_Data), m_Size);
+    }
+}
+
+bool CategoryFile::scanLine(std::string_view a_Line, Line &a_Result) {
+    if (!a_Line.empty() && a_Line.back() == '\r') {
+        a_Line.remove_suffix(1);
+    }
+    if (a_Line.empty()) {
+        return false;
+    }
+    a_Result.m_Name = a_Line;
+    a_Result.m_Probability = 0.0;
+    a_Result.m_HasProbability = false;
+
+    const size_t comma = a_Line.rfind(',');
+    if (comma == std::string_view::npos || comma == 0) {
+        return true;
+    }
+    const std::string_view probability = a_Line.substr(comma + 1);
+    const auto is_digit = [](const char a_Character) {
+        return a_Character >= '0' && a_Character <= '9';
+    };
+    const bool is_one = probability == "1";
+    const bool is_fraction = probability.size() >= 3 && is_digit(probability[0]) && probability[1] == '.' &&
+                             std::all_of(probability.begin() + 2, probability.end(), is_digit);
+    if (!is_one && !is_fraction) {
+        return true;
+    }
+    const auto result = std::from_chars(probability.data(), probability.data() + probability.size(),
+                                        a_Result.m_Probability);
+    if (result.ec != std::errc()) {
+        throw std::invalid_argument("Category probability must be a valid number.");
+    }
+    a_Result.m_HasProbability = true;
+    a_Result.m_Name = a_Line.substr(0, comma);
+    // A name in quotes may hold commas itself.
+    if (a_Result.m_Name.size() >= 3 && a_Result.m_Name.front() == '"' && a_Result.m_Name.back() == '"') {
+        a_Result.m_Name = a_Result.m_Name.substr(1, a_Result.m_Name.size() - 2);
+    }
+    return true;
+}
+
+void CategoryFile::scanChunk(const std::string_view a_Chunk, std::vector<Line> &a_Lines) {
+    size_t start = 0;
+    while (start < a_Chunk.size()) {
+        const size_t end = std::min(a_Chunk.find('\n', start), a_Chunk.size());
+        Line line{};
+        if (scanLine(a_Chunk.substr(start, end - start), line)) {
+            a_Lines.push_back(line);
+        }
+        start = end + 1;
+    }
+}
+
+std::vector<std::string_view> CategoryFile::getChunks(const size_t a_NrOfChunks) const {
+    // Every chunk ends just after a newline, or at the end of the file.
+    std::vector<std::string_view> chunks;
+    const std::string_view file(m_Data, m_Size);
+    size_t start = 0;
+    for (size_t i = 1; i <= a_NrOfChunks && start < m_Size; ++i) {
+        size_t end = m_Size;
+        if (i < a_NrOfChunks) {
+            const size_t newline = file.find('\n', std::max(start, m_Size / a_NrOfChunks * i));
+            end = newline == std::string_view::npos ? m_Size : newline + 1;
+        }
+        chunks.push_back(file.substr(start, end - start));
+        start = end;
+    }
+    return chunks;
+}
+
+double CategoryFile::readCategories(ThreadPool &a_ThreadPool, StringPool &a_Categories,
+                                    std::vector<double> &a_Probabilities) const {
+    const size_t max_chunks = std::max<size_t>(m_Size / m_MinChunkSize, 1);
+    const std::vector<std::string_view> chunks = getChunks(std::min<size_t>(max_chunks,
+                                                                            a_ThreadPool.getNrOfThreads()));
+    std::vector<std::vector<Line>> chunk_lines(chunks.size());
+    if (chunks.size() == 1) {
+        scanChunk(chunks[0], chunk_lines[0]);
+    } else {
+        a_ThreadPool.parallelFor(chunks.size(), [&](const size_t a_Chunk) {
+            scanChunk(chunks[a_Chunk], chunk_lines[a_Chunk]);
+        });
+    }
+
+    size_t nr_lines = 0;
+    for (const auto &lines : chunk_lines) {
+        nr_lines += lines.size();
+    }
+    a_Categories.reserve(a_Categories.size() + nr_lines, m_Size);
+    a_Probabilities.reserve(a_Probabilities.size() + nr_lines);
+    double total_probability = 0.0;
+    for (const auto &lines : chunk_lines) {
+        for (const Line &line : lines) {
+            if (line.m_HasProbability) {
+                if (line.m_Probability < 0.0 || line.m_Probability > 1.0) {
+                    throw std::invalid_argument("Category probability must be in the range [0,1]");
+                }
+                total_probability += line.m_Probability;
+            } else if (total_probability > 0.0) {
+                throw std::invalid_argument("Probability needs to be specified on all categories or none");
+            }
+            if (a_Categories.intern(line.m_Name) != a_Probabilities.size()) {
+                throw std::invalid_argument("Category defined multiple times");
+            }
+            a_Probabilities.push_back(line.m_Probability);
+        }
+    }
+    return total_probability;
+}
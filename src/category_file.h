@@ -0,0 +1,52 @@
+#ifndef GMARK_CATEGORY_FILE_H
+#define GMARK_CATEGORY_FILE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "string_pool.h"
+#include "thread_pool.h"
+
+// A category file, mapped into memory. Every non-empty line is a category, either a bare name or a name and a
+// probability separated by the last comma of the line, like "name,0.25" or "\"a, b\",1". The probability is 1 or a
+// digit, a dot and more digits; any other line is a bare name. Lines may end in "\r\n".
+//
+// Large files are scanned in chunks of whole lines by the threads of the given thread pool. The categories are then
+// added to the string pool in the order of the file, so the result does not depend on the number of threads.
+class CategoryFile {
+private:
+    // A scanned line. The name points into the mapped file.
+    struct Line {
+        std::string_view m_Name;
+        double m_Probability;
+        bool m_HasProbability;
+    };
+
+    static const size_t m_MinChunkSize;
+
+    const char *m_Data = nullptr;
+    size_t m_Size = 0;
+
+    static bool scanLine(std::string_view a_Line, Line &a_Result);
+
+    static void scanChunk(std::string_view a_Chunk, std::vector<Line> &a_Lines);
+
+    std::vector<std::string_view> getChunks(const size_t a_NrOfChunks) const;
+
+public:
+    CategoryFile(const CategoryFile &) = delete; // no copy operations.
+    CategoryFile &operator=(const CategoryFile &) = delete; // no copy operations.
+    CategoryFile(CategoryFile &&) = delete; // no move operations.
+    CategoryFile &operator=(CategoryFile &&) = delete; // no move operations.
+
+    explicit CategoryFile(const std::string &a_FileName);
+
+    ~CategoryFile();
+
+    // Adds the categories to a_Categories and their probabilities to a_Probabilities, 0 for categories without one,
+    // and returns the sum of the probabilities.
+    double readCategories(ThreadPool &a_ThreadPool, StringPool &a_Categories,
+                          std::vector<double> &a_Probabilities) const;
+};
+
+#endif //GMARK_CATEGORY_FILE_H
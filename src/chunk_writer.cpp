@@ -0,0 +1,49 @@
+#include "chunk_writer.h"
+#include <cassert>
+
+ChunkWriter::ChunkWriter(OutputWriter &a_Writer, const size_t a_NrOfChunks, const bool a_Ordered)
+        : m_Writer(a_Writer),
+          m_Ordered(a_Ordered),
+          m_Pending(a_NrOfChunks),
+          m_Committed(a_NrOfChunks, false) {}
+
+size_t ChunkWriter::addChunks(const size_t a_NrOfChunks) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const size_t first_chunk = m_Committed.size();
+    m_Pending.resize(first_chunk + a_NrOfChunks);
+    m_Committed.resize(first_chunk + a_NrOfChunks, false);
+    return first_chunk;
+}
+
+OutputBuffer ChunkWriter::getBuffer() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_FreeBuffers.empty()) {
+        return OutputBuffer();
+    }
+    OutputBuffer buffer = std::move(m_FreeBuffers.back());
+    m_FreeBuffers.pop_back();
+    return buffer;
+}
+
+void ChunkWriter::writeBuffer(OutputBuffer &a_Buffer) {
+    m_Writer.write(a_Buffer.getData(), a_Buffer.getSize());
+    a_Buffer.clear();
+    m_FreeBuffers.push_back(std::move(a_Buffer));
+}
+
+void ChunkWriter::commit(const size_t a_Chunk, OutputBuffer a_Buffer) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    assert(a_Chunk < m_Committed.size());
+    assert(!m_Committed[a_Chunk]);
+    m_Committed[a_Chunk] = true;
+    if (!m_Ordered) {
+        writeBuffer(a_Buffer);
+        return;
+    }
+    m_Pending[a_Chunk] = std::move(a_Buffer);
+    while (m_NextChunk < m_Committed.size() && m_Committed[m_NextChunk]) {
+        writeBuffer(*m_Pending[m_NextChunk]);
+        m_Pending[m_NextChunk].reset();
+        ++m_NextChunk;
+    }
+}
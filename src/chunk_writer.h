@@ -0,0 +1,42 @@
+#ifndef GMARK_CHUNK_WRITER_H
+#define GMARK_CHUNK_WRITER_H
+
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "output_writer.h"
+
+// Collects output chunks that are produced concurrently and writes them to a single writer. In ordered mode the
+// chunks are written in index order as soon as all preceding chunks are available, which gives the same output
+// as a sequential run. In unordered mode every chunk is written as soon as it is committed. The buffers of written
+// chunks are kept and handed out again, so that producing chunks does not allocate once the buffers have grown.
+class ChunkWriter {
+private:
+    OutputWriter &m_Writer;
+    const bool m_Ordered;
+    std::mutex m_Mutex;
+    std::vector<std::optional<OutputBuffer>> m_Pending;
+    std::vector<bool> m_Committed;
+    std::vector<OutputBuffer> m_FreeBuffers;
+    size_t m_NextChunk = 0;
+
+    // Writes a_Buffer and keeps its memory for getBuffer. The mutex must be held.
+    void writeBuffer(OutputBuffer &a_Buffer);
+
+public:
+    ChunkWriter(const ChunkWriter &) = delete; // no copy operations.
+    ChunkWriter &operator=(const ChunkWriter &) = delete; // no copy operations.
+
+    ChunkWriter(OutputWriter &a_Writer, const size_t a_NrOfChunks, const bool a_Ordered);
+
+    // Adds a_NrOfChunks chunks after the existing ones and returns the index of the first, for producers that only
+    // learn how many chunks they have along the way.
+    size_t addChunks(const size_t a_NrOfChunks);
+
+    // An empty detached buffer to produce a chunk in, which reuses the memory of a written chunk if there is one.
+    OutputBuffer getBuffer();
+
+    void commit(const size_t a_Chunk, OutputBuffer a_Buffer);
+};
+
+#endif //GMARK_CHUNK_WRITER_H
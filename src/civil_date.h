@@ -0,0 +1,50 @@
+#ifndef GMARK_CIVIL_DATE_H
+#define GMARK_CIVIL_DATE_H
+
+#include <cstdint>
+
+// Conversions between days since 1970-01-01 and dates of the proleptic Gregorian calendar, in pure integer
+// arithmetic. Dates are UTC, so they depend neither on the time zone nor on the C library's global time state, and
+// the conversions are safe to use from several threads. The algorithms shift the year to start in March, so that
+// the leap day is the last day of the year, and count in eras of 400 years, which all have 146097 days.
+
+struct CivilDate {
+    int64_t m_Year;
+    unsigned int m_Month; // 1 to 12.
+    unsigned int m_Day; // 1 to 31.
+};
+
+inline bool isLeapYear(const int64_t a_Year) {
+    return a_Year % 4 == 0 && (a_Year % 100 != 0 || a_Year % 400 == 0);
+}
+
+inline unsigned int getDaysInMonth(const int64_t a_Year, const unsigned int a_Month) {
+    constexpr unsigned int days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return a_Month == 2 && isLeapYear(a_Year) ? 29 : days_in_month[a_Month - 1];
+}
+
+inline int64_t daysFromCivil(const CivilDate &a_Date) {
+    const int64_t year = a_Date.m_Month <= 2 ? a_Date.m_Year - 1 : a_Date.m_Year;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const auto year_of_era = static_cast<uint64_t>(year - era * 400); // [0, 399]
+    const uint64_t month_from_march = a_Date.m_Month > 2 ? a_Date.m_Month - 3 : a_Date.m_Month + 9; // [0, 11]
+    const uint64_t day_of_year = (153 * month_from_march + 2) / 5 + a_Date.m_Day - 1; // [0, 365]
+    const uint64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year; // [0, 146096]
+    return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+}
+
+inline CivilDate civilFromDays(const int64_t a_Days) {
+    const int64_t days = a_Days + 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto day_of_era = static_cast<uint64_t>(days - era * 146097); // [0, 146096]
+    const uint64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const uint64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const uint64_t month_from_march = (5 * day_of_year + 2) / 153; // [0, 11]
+    CivilDate date{};
+    date.m_Day = static_cast<unsigned int>(day_of_year - (153 * month_from_march + 2) / 5 + 1);
+    date.m_Month = static_cast<unsigned int>(month_from_march < 10 ? month_from_march + 3 : month_from_march - 9);
+    date.m_Year = static_cast<int64_t>(year_of_era) + era * 400 + (date.m_Month <= 2 ? 1 : 0);
+    return date;
+}
+
+#endif //GMARK_CIVIL_DATE_H
@@ -1,6 +1,8 @@
 #include "configuration.h"
 
-Configuration::Configuration(const std::string &a_Filename, const int a_GraphSize) {
+Configuration::Configuration(const std::string &a_Filename, const uint64_t a_GraphSize, const uint64_t a_Seed,
+                             ThreadPool &a_ThreadPool)
+        : m_RandomStream(a_Seed) {
     assert(a_GraphSize > 0);
     pugi::xml_document doc = openFile(a_Filename);
     pugi::xml_node root = doc.child("pgmark");
@@ -9,8 +11,11 @@ Configuration::Configuration(const std::string &a_Filename, const int a_GraphSiz
     }
     pugi::xml_node types_node = root.child("types");
     pugi::xml_node predicates_node = root.child("predicates");
-    m_Schema = std::make_unique<Schema>(types_node, predicates_node, a_GraphSize);
+    m_Schema = std::make_unique<Schema>(types_node, predicates_node, a_GraphSize, a_ThreadPool);
     m_TypeRanges = computeTypeRanges();
+    for (const auto &type_range : m_TypeRanges) {
+        m_NrOfNodes = std::max(m_NrOfNodes, type_range.second.second + 1);
+    }
 }
 
 pugi::xml_document Configuration::openFile(const std::string &a_Filename) {
@@ -25,11 +30,11 @@ pugi::xml_document Configuration::openFile(const std::string &a_Filename) {
     throw std::invalid_argument("Invalid XML input file");
 }
 
-const std::map<std::string, std::pair<int, int>> Configuration::computeTypeRanges() const {
-    std::map<std::string, std::pair<int, int>> type_ranges;
+const std::map<std::string, std::pair<uint64_t, uint64_t>> Configuration::computeTypeRanges() const {
+    std::map<std::string, std::pair<uint64_t, uint64_t>> type_ranges;
 
     const auto &types = getTypeNames();
-    int node_count = 0;
+    uint64_t node_count = 0;
     for (const auto &type : types) {
         const auto nr_nodes = getConstraint(type);
         assert(nr_nodes > 0);
@@ -2,18 +2,23 @@
 #define GMARK_CONFIGURATION_H
 
 #include "schema.h"
+#include "random_stream.h"
 
 class Configuration {
 private:
     std::unique_ptr<Schema> m_Schema;
-    std::map<std::string, std::pair<int, int>> m_TypeRanges;
+    std::map<std::string, std::pair<uint64_t, uint64_t>> m_TypeRanges;
+    uint64_t m_NrOfNodes = 0;
+    const RandomStream m_RandomStream;
 
     static pugi::xml_document openFile(const std::string &a_Filename);
 
-    const std::map<std::string, std::pair<int, int>> computeTypeRanges() const;
+    const std::map<std::string, std::pair<uint64_t, uint64_t>> computeTypeRanges() const;
 
 public:
-    Configuration(const std::string &a_Filename, const int a_GraphSize);
+    // Category files are read with the threads of a_ThreadPool.
+    Configuration(const std::string &a_Filename, const uint64_t a_GraphSize, const uint64_t a_Seed,
+                  ThreadPool &a_ThreadPool);
 
     Configuration(const Configuration &) = delete; // No copying.
     Configuration &operator=(const Configuration &) = delete; // No copying.
@@ -47,17 +52,26 @@ public:
         return m_Schema->getTypes().at(a_TypeName);
     }
 
-    const std::map<std::string, int> &getConstraints() const {
+    const std::map<std::string, uint64_t> &getConstraints() const {
         return m_Schema->getConstraints();
     }
 
-    int getConstraint(const std::string &a_TypeName) const {
+    uint64_t getConstraint(const std::string &a_TypeName) const {
         return m_Schema->getConstraints().at(a_TypeName);
     }
 
-    const std::pair<int, int> &getTypeRange(const std::string &a_Type) const {
+    const std::pair<uint64_t, uint64_t> &getTypeRange(const std::string &a_Type) const {
         return m_TypeRanges.at(a_Type);
     }
+
+    uint64_t getNrOfNodes() const {
+        return m_NrOfNodes;
+    }
+
+    // The root stream that all random values are derived from.
+    const RandomStream &getRandomStream() const {
+        return m_RandomStream;
+    }
 };
 
 #endif //GMARK_CONFIGURATION_H
@@ -0,0 +1,58 @@
+#ifndef GMARK_FLAT_NODE_SET_H
+#define GMARK_FLAT_NODE_SET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A set of node ids with open addressing and linear probing that is emptied and reused for every fixed node while
+// pairing stubs. Slots are marked as used with the stamp of the current round, so emptying the set is O(1). A round
+// only probes the first power of two slots that hold twice its number of insertions, so small rounds stay in the
+// cache after a large one. The table only grows when a round needs more slots than any round before it.
+template<typename NodeId>
+class FlatNodeSet {
+private:
+    std::vector<NodeId> m_Nodes;
+    std::vector<uint32_t> m_Stamps;
+    uint32_t m_Stamp = 0;
+    unsigned int m_Bits = 1;
+    size_t m_Mask = 0;
+
+public:
+    // Empties the set, which can then hold a_MaxSize nodes.
+    void reset(const size_t a_MaxSize) {
+        m_Bits = 1;
+        while ((static_cast<size_t>(1) << m_Bits) < 2 * a_MaxSize) {
+            ++m_Bits;
+        }
+        const size_t nr_slots = static_cast<size_t>(1) << m_Bits;
+        m_Mask = nr_slots - 1;
+        if (nr_slots > m_Stamps.size()) {
+            m_Nodes.assign(nr_slots, 0);
+            m_Stamps.assign(nr_slots, 0);
+            m_Stamp = 0;
+        }
+        if (++m_Stamp == 0) {
+            std::fill(m_Stamps.begin(), m_Stamps.end(), 0);
+            m_Stamp = 1;
+        }
+    }
+
+    // Returns false when a_Node was already in the set.
+    bool insert(const NodeId a_Node) {
+        // Fibonacci hashing, which spreads consecutive node ids over the table.
+        size_t slot = static_cast<size_t>((static_cast<uint64_t>(a_Node) * 0x9e3779b97f4a7c15ULL) >> (64U - m_Bits));
+        while (m_Stamps[slot] == m_Stamp) {
+            if (m_Nodes[slot] == a_Node) {
+                return false;
+            }
+            slot = (slot + 1) & m_Mask;
+        }
+        m_Stamps[slot] = m_Stamp;
+        m_Nodes[slot] = a_Node;
+        return true;
+    }
+};
+
+#endif //GMARK_FLAT_NODE_SET_H
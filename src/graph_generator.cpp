@@ -1,77 +1,485 @@
 #include "graph_generator.h"
+#include "parallel_shuffle.h"
+#include "flat_node_set.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <random>
 
-std::vector<int>
-generateNodeDistributions(RandomDistribution *const a_Distribution, const int a_StartId, const int a_EndId) {
-    std::vector<int> nodes;
-    int amount = a_EndId - a_StartId + 1;
-    assert(amount > 0);
-    nodes.reserve(
-            static_cast<size_t>(static_cast<double>(amount) *
-                                a_Distribution->getMean())); // Maybe use confidence interval?
-
-    for (int node_id = a_StartId; node_id <= a_EndId; ++node_id) {
-        int nr_relations = a_Distribution->getRandomInteger();
-        for (int i = 0; i < nr_relations; ++i) {
-            nodes.push_back(node_id);
+const size_t GraphGenerator::m_MinEdgesPerPartition = 1U << 16U;
+const size_t GraphGenerator::m_MaxEdgesPerPartition = 1U << 17U;
+const size_t GraphGenerator::m_PartitionsPerThread = 4;
+const char GraphGenerator::m_BinaryMagic[8] = {'P', 'G', 'M', 'A', 'R', 'K', 'B', '\0'};
+const char GraphGenerator::m_AdjacencyMagic[8] = {'P', 'G', 'M', 'A', 'R', 'K', 'C', '\0'};
+const uint32_t GraphGenerator::m_BinaryVersion = 1;
+
+std::vector<size_t>
+generateNodeDegrees(RandomDistribution *const a_Distribution, const uint64_t a_StartId, const uint64_t a_EndId,
+                    const RandomStream &a_Stream, ThreadPool &a_ThreadPool) {
+    assert(a_StartId <= a_EndId);
+    const size_t nr_nodes = a_EndId - a_StartId + 1;
+    // Each block of nodes draws from its own stream, so the blocks can be drawn in parallel.
+    std::vector<size_t> offsets(nr_nodes + 1, 0);
+    const size_t nr_streams = (nr_nodes + RandomStream::m_NodesPerStream - 1) / RandomStream::m_NodesPerStream;
+    a_ThreadPool.parallelFor(nr_streams, [a_Distribution, &a_Stream, &offsets, nr_nodes](const size_t a_Block) {
+        RandomStream generator = a_Stream.split(a_Block);
+        const size_t first = a_Block * RandomStream::m_NodesPerStream;
+        const size_t last = std::min(first + RandomStream::m_NodesPerStream, nr_nodes);
+        std::vector<int> degrees(last - first);
+        a_Distribution->getRandomIntegers(generator, degrees.data(), degrees.size());
+        for (size_t i = first; i < last; ++i) {
+            offsets[i + 1] = static_cast<size_t>(std::max(degrees[i - first], 0));
         }
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    return offsets;
+}
+
+void balanceNodeDegrees(std::vector<size_t> &a_Offsets, const size_t a_NrOfStubs, const RandomStream &a_Stream,
+                        ThreadPool &a_ThreadPool) {
+    assert(!a_Offsets.empty());
+    const size_t nr_stubs = a_Offsets.back();
+    if (nr_stubs <= a_NrOfStubs) {
+        return;
     }
+    // Every stub is first kept with probability a_NrOfStubs / nr_stubs, with one binomial draw per node. Then the
+    // difference to a_NrOfStubs, which is about the square root of the stubs, is made up by dropping uniformly
+    // random kept stubs or keeping uniformly random dropped ones. Both steps treat all stubs alike, so the result
+    // is a uniformly random subset of the stubs, while the time is linear in the nodes and the kept stubs.
+    const double keep_probability = static_cast<double>(a_NrOfStubs) / static_cast<double>(nr_stubs);
+    const size_t nr_nodes = a_Offsets.size() - 1;
+    std::vector<size_t> kept(nr_nodes, 0);
+    const size_t nr_blocks = (nr_nodes + RandomStream::m_NodesPerStream - 1) / RandomStream::m_NodesPerStream;
+    a_ThreadPool.parallelFor(nr_blocks, [&a_Offsets, &a_Stream, &kept, keep_probability, nr_nodes](
+            const size_t a_Block) {
+        RandomStream generator = a_Stream.split(a_Block);
+        const size_t first = a_Block * RandomStream::m_NodesPerStream;
+        const size_t last = std::min(first + RandomStream::m_NodesPerStream, nr_nodes);
+        for (size_t i = first; i < last; ++i) {
+            const size_t degree = a_Offsets[i + 1] - a_Offsets[i];
+            if (degree > 0) {
+                std::binomial_distribution<size_t> distribution(degree, keep_probability);
+                kept[i] = distribution(generator);
+            }
+        }
+    });
+
+    const size_t nr_kept = std::accumulate(kept.begin(), kept.end(), static_cast<size_t>(0));
+    if (nr_kept != a_NrOfStubs) {
+        // The candidates of a node are its kept stubs when there are too many, and its dropped stubs otherwise.
+        const bool drop = nr_kept > a_NrOfStubs;
+        const size_t nr_changes = drop ? nr_kept - a_NrOfStubs : a_NrOfStubs - nr_kept;
+        std::vector<size_t> candidate_offsets(nr_nodes + 1, 0);
+        for (size_t i = 0; i < nr_nodes; ++i) {
+            const size_t nr_candidates = drop ? kept[i] : a_Offsets[i + 1] - a_Offsets[i] - kept[i];
+            candidate_offsets[i + 1] = candidate_offsets[i] + nr_candidates;
+        }
+        // Distinct candidate indices, drawn until there are enough of them.
+        RandomStream generator = a_Stream.split("changes");
+        std::uniform_int_distribution<size_t> distribution(0, candidate_offsets.back() - 1);
+        std::vector<size_t> changes;
+        while (changes.size() < nr_changes) {
+            while (changes.size() < nr_changes) {
+                changes.push_back(distribution(generator));
+            }
+            std::sort(changes.begin(), changes.end());
+            changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+        }
+        for (const size_t change : changes) {
+            const auto owner = std::upper_bound(candidate_offsets.begin(), candidate_offsets.end(), change);
+            const auto node = static_cast<size_t>(std::distance(candidate_offsets.begin(), owner)) - 1;
+            if (drop) {
+                --kept[node];
+            } else {
+                ++kept[node];
+            }
+        }
+    }
+
+    a_Offsets[0] = 0;
+    for (size_t i = 0; i < nr_nodes; ++i) {
+        a_Offsets[i + 1] = a_Offsets[i] + kept[i];
+    }
+    assert(a_Offsets.back() == a_NrOfStubs);
+}
+
+template<typename NodeId>
+std::vector<NodeId> generateNodeStubs(const std::vector<size_t> &a_Offsets, const NodeId a_StartId,
+                                      ThreadPool &a_ThreadPool) {
+    assert(!a_Offsets.empty());
+    const size_t nr_nodes = a_Offsets.size() - 1;
+    std::vector<NodeId> nodes(a_Offsets.back());
+    const size_t nr_blocks = std::min(static_cast<size_t>(a_ThreadPool.getNrOfThreads()), nr_nodes);
+    a_ThreadPool.parallelFor(nr_blocks, [&a_Offsets, &nodes, a_StartId, nr_nodes, nr_blocks](const size_t a_Block) {
+        const size_t first = a_Block * nr_nodes / nr_blocks;
+        const size_t last = (a_Block + 1) * nr_nodes / nr_blocks;
+        for (size_t i = first; i < last; ++i) {
+            const NodeId node_id = a_StartId + static_cast<NodeId>(i);
+            std::fill(nodes.begin() + static_cast<std::ptrdiff_t>(a_Offsets[i]),
+                      nodes.begin() + static_cast<std::ptrdiff_t>(a_Offsets[i + 1]), node_id);
+        }
+    });
     return nodes;
 }
 
-void GraphGenerator::generateRandomEdges(const RelationDistribution &a_Relation,
-                                         std::ostream &a_OutputStream) const {
-    const auto &source_range = m_Config.getTypeRange(a_Relation.getSource());
-    const auto &target_range = m_Config.getTypeRange(a_Relation.getTarget());
-    const std::string &predicate = a_Relation.getPredicate();
-    const bool loops_allowed = a_Relation.getLoopsAreAllowed();
-    const bool parallel_edges_allowed = a_Relation.getParallelEdgesAreAllowed();
-
-    std::vector<int> source_nodes = generateNodeDistributions(a_Relation.getOutDistribution(), source_range.first,
-                                                              source_range.second);
-    std::vector<int> target_nodes = generateNodeDistributions(a_Relation.getInDistribution(), target_range.first,
-                                                              target_range.second);
-    const size_t nr_edges = std::min(source_nodes.size(), target_nodes.size());
-    if (nr_edges == 0) {
-        return;
+template std::vector<uint32_t> generateNodeStubs(const std::vector<size_t> &a_Offsets, const uint32_t a_StartId,
+                                                ThreadPool &a_ThreadPool);
+
+template std::vector<uint64_t> generateNodeStubs(const std::vector<size_t> &a_Offsets, const uint64_t a_StartId,
+                                                ThreadPool &a_ThreadPool);
+
+template<typename NodeId>
+RelationStubs<NodeId> GraphGenerator::generateRelationStubs(const RelationDistribution &a_Relation,
+                                                            const RandomStream &a_Stream) const {
+    return generateRelationStubs<NodeId>(a_Relation, m_Config.getTypeRange(a_Relation.getSource()),
+                                         m_Config.getTypeRange(a_Relation.getTarget()), a_Stream);
+}
+
+template<typename NodeId>
+RelationStubs<NodeId> GraphGenerator::generateRelationStubs(const RelationDistribution &a_Relation,
+                                                            const std::pair<uint64_t, uint64_t> &a_SourceRange,
+                                                            const std::pair<uint64_t, uint64_t> &a_TargetRange,
+                                                            const RandomStream &a_Stream) const {
+    const auto &source_range = a_SourceRange;
+    const auto &target_range = a_TargetRange;
+
+    std::vector<size_t> source_offsets = generateNodeDegrees(a_Relation.getOutDistribution(), source_range.first,
+                                                             source_range.second, a_Stream.split("out"),
+                                                             m_ThreadPool);
+    std::vector<size_t> target_offsets = generateNodeDegrees(a_Relation.getInDistribution(), target_range.first,
+                                                             target_range.second, a_Stream.split("in"),
+                                                             m_ThreadPool);
+    RelationStubs<NodeId> stubs;
+    stubs.m_NrOfEdges = std::min(source_offsets.back(), target_offsets.back());
+    if (stubs.m_NrOfEdges == 0) {
+        return stubs;
+    }
+    stubs.m_Streaming = m_StreamingEdges;
+    stubs.m_SourcesAreShuffled = source_offsets.back() >= target_offsets.back();
+    stubs.m_FixedStartId = static_cast<NodeId>(stubs.m_SourcesAreShuffled ? target_range.first
+                                                                          : source_range.first);
+    stubs.m_ShuffledStartId = static_cast<NodeId>(stubs.m_SourcesAreShuffled ? source_range.first
+                                                                             : target_range.first);
+    stubs.m_FixedOffsets = std::move(stubs.m_SourcesAreShuffled ? target_offsets : source_offsets);
+    auto &shuffled_offsets = stubs.m_SourcesAreShuffled ? source_offsets : target_offsets;
+    balanceNodeDegrees(shuffled_offsets, stubs.m_NrOfEdges, a_Stream.split("balance"), m_ThreadPool);
+    if (m_StreamingEdges) {
+        stubs.m_ShuffledPermutation = FeistelPermutation(shuffled_offsets.back(), a_Stream.split("permutation"));
+        stubs.m_ShuffledOffsets = std::move(shuffled_offsets);
+    } else {
+        stubs.m_ShuffledNodes = generateNodeStubs(shuffled_offsets, stubs.m_ShuffledStartId, m_ThreadPool);
+        parallelShuffle(stubs.m_ShuffledNodes, a_Stream.split("shuffle"), m_ThreadPool);
+    }
+    return stubs;
+}
+
+size_t GraphGenerator::getNrOfPartitions(const size_t a_NrOfEdges, const unsigned int a_NrOfThreads) {
+    return std::max({static_cast<size_t>(1),
+                     std::min(a_NrOfThreads * m_PartitionsPerThread, a_NrOfEdges / m_MinEdgesPerPartition),
+                     (a_NrOfEdges + m_MaxEdgesPerPartition - 1) / m_MaxEdgesPerPartition});
+}
+
+std::vector<std::pair<size_t, size_t>>
+GraphGenerator::getStubPartitions(const std::vector<size_t> &a_FixedOffsets) const {
+    const auto &offsets = a_FixedOffsets;
+    const size_t nr_edges = offsets.back();
+    const size_t nr_nodes = offsets.size() - 1;
+    const size_t nr_partitions = getNrOfPartitions(nr_edges, m_ThreadPool.getNrOfThreads());
+    // Partitions are ranges of fixed nodes with roughly equal numbers of stubs, so that all stubs of a fixed node
+    // are paired by the same partition.
+    std::vector<std::pair<size_t, size_t>> partitions;
+    size_t first_node = 0;
+    for (size_t i = 1; i <= nr_partitions && first_node < nr_nodes; ++i) {
+        const size_t stub = i * nr_edges / nr_partitions;
+        const auto last = std::lower_bound(offsets.begin(), offsets.end(), stub);
+        const size_t last_node = i == nr_partitions ? nr_nodes
+                                                    : static_cast<size_t>(std::distance(offsets.begin(), last));
+        if (last_node > first_node) {
+            partitions.emplace_back(first_node, last_node);
+            first_node = last_node;
+        }
     }
-    std::mt19937 generator{std::random_device{}()};
-    const bool sources_are_shuffled = source_nodes.size() >= target_nodes.size();
-    auto &shuffled_nodes = sources_are_shuffled ? source_nodes : target_nodes;
-    const auto &fixed_nodes = sources_are_shuffled ? target_nodes : source_nodes;
-    shuffle(shuffled_nodes.begin(), shuffled_nodes.end(), generator);
-    const auto *fixed_nodes_distribution = sources_are_shuffled ? a_Relation.getInDistribution()
-                                                                : a_Relation.getOutDistribution();
-    const auto expected_fixed_nodes = static_cast<size_t>(std::ceil(fixed_nodes_distribution->getMean()));
-    std::unordered_set<int> shuffled_nodes_seen(expected_fixed_nodes);
-    int lastFixed = fixed_nodes[0];
-    for (size_t i = 0; i < nr_edges; ++i) {
-        const int fixed = fixed_nodes[i];
-        const int shuffled = shuffled_nodes[i];
+    return partitions;
+}
+
+template<typename NodeId, typename EdgeSink>
+void GraphGenerator::pairStubs(const size_t a_RelationIndex, const RelationStubs<NodeId> &a_Stubs,
+                               const size_t a_FirstNode, const size_t a_LastNode, EdgeSink &&a_Sink) const {
+    assert(a_FirstNode < a_LastNode && a_LastNode < a_Stubs.m_FixedOffsets.size());
+    const auto &relation = m_Config.getRelationDistributions()[a_RelationIndex];
+    const bool loops_allowed = relation.getLoopsAreAllowed();
+    const bool parallel_edges_allowed = relation.getParallelEdgesAreAllowed();
+    const bool sources_are_shuffled = a_Stubs.m_SourcesAreShuffled;
+    const auto &fixed_offsets = a_Stubs.m_FixedOffsets;
+    // The stubs of a fixed node are contiguous, so parallel edges can only occur among the stubs of one fixed node
+    // and checking every fixed node on its own is exact for the whole relation.
+    FlatNodeSet<NodeId> shuffled_nodes_seen;
+    for (size_t node = a_FirstNode; node < a_LastNode; ++node) {
+        const NodeId fixed = a_Stubs.m_FixedStartId + static_cast<NodeId>(node);
         if (!parallel_edges_allowed) {
-            if (fixed != lastFixed) {
-                lastFixed = fixed;
-                shuffled_nodes_seen.clear();
-            } else if (shuffled_nodes_seen.find(shuffled) != shuffled_nodes_seen.end()) {
+            shuffled_nodes_seen.reset(fixed_offsets[node + 1] - fixed_offsets[node]);
+        }
+        for (size_t i = fixed_offsets[node]; i < fixed_offsets[node + 1]; ++i) {
+            const NodeId shuffled = a_Stubs.getShuffledNode(i);
+            if (!parallel_edges_allowed && !shuffled_nodes_seen.insert(shuffled)) {
                 continue;
             }
-            shuffled_nodes_seen.insert(shuffled);
+            if (loops_allowed || shuffled != fixed) {
+                if (sources_are_shuffled) {
+                    a_Sink(shuffled, fixed);
+                } else {
+                    a_Sink(fixed, shuffled);
+                }
+            }
         }
-        if (loops_allowed || shuffled != fixed) {
-            if (sources_are_shuffled) {
-                writeEdge(shuffled, fixed, predicate, a_OutputStream);
-            } else {
-                writeEdge(fixed, shuffled, predicate, a_OutputStream);
+    }
+}
+
+template<typename NodeId>
+void GraphGenerator::generateRandomEdges(const size_t a_RelationIndex, OutputBuffer &a_Buffer) const {
+    const auto &relation = m_Config.getRelationDistributions()[a_RelationIndex];
+    const auto stubs = generateRelationStubs<NodeId>(relation, getRelationStream(a_RelationIndex));
+    if (stubs.m_NrOfEdges == 0) {
+        return;
+    }
+    pairStubs(a_RelationIndex, stubs, 0, stubs.m_FixedOffsets.size() - 1, getEdgeWriter<NodeId>(a_RelationIndex,
+                                                                                               a_Buffer));
+}
+
+template<typename NodeId>
+void GraphGenerator::generateRandomEdgePartitions(const size_t a_RelationIndex, ChunkWriter &a_Writer) const {
+    const auto &relation = m_Config.getRelationDistributions()[a_RelationIndex];
+    const auto stubs = generateRelationStubs<NodeId>(relation, getRelationStream(a_RelationIndex));
+    if (stubs.m_NrOfEdges == 0) {
+        return;
+    }
+    const auto partitions = getStubPartitions(stubs.m_FixedOffsets);
+    const size_t first_chunk = a_Writer.addChunks(partitions.size());
+    // An ordered partition that is done before the ones in front of it waits in memory, so the partitions are
+    // paired in windows and at most one window of them is held. Unordered partitions are written once they are done.
+    const size_t window_size = m_OrderedOutput ? getNrOfPartitionsPerWindow(m_ThreadPool.getNrOfThreads())
+                                               : partitions.size();
+    for (size_t window = 0; window < partitions.size(); window += window_size) {
+        const size_t nr_partitions = std::min(window_size, partitions.size() - window);
+        m_ThreadPool.parallelFor(nr_partitions, [this, a_RelationIndex, &stubs, &partitions, window, first_chunk,
+                &a_Writer](const size_t a_Index) {
+            const auto &partition = partitions[window + a_Index];
+            OutputBuffer buffer = a_Writer.getBuffer();
+            pairStubs(a_RelationIndex, stubs, partition.first, partition.second,
+                      getEdgeWriter<NodeId>(a_RelationIndex, buffer));
+            a_Writer.commit(first_chunk + window + a_Index, std::move(buffer));
+        });
+    }
+}
+
+template<typename NodeId>
+void GraphGenerator::generateRelations(OutputWriter &a_Writer) {
+    const auto &relations = m_Config.getRelationDistributions();
+    if (m_ThreadPool.getNrOfThreads() == 1) {
+        OutputBuffer buffer(&a_Writer);
+        for (size_t i = 0; i < relations.size(); ++i) {
+            generateRandomEdges<NodeId>(i, buffer);
+        }
+        buffer.flush();
+        return;
+    }
+    // Relations are split into partitions that the chunk writer writes as soon as they, and in ordered mode all
+    // partitions before them, are done. In ordered mode the relations are generated one after another, each with all
+    // threads, so that the partitions of a later relation do not pile up behind an earlier one. Every relation owns
+    // its distributions, so in unordered mode the relations are generated concurrently.
+    ChunkWriter writer(a_Writer, 0, m_OrderedOutput);
+    if (m_OrderedOutput) {
+        for (size_t i = 0; i < relations.size(); ++i) {
+            generateRandomEdgePartitions<NodeId>(i, writer);
+        }
+        return;
+    }
+    m_ThreadPool.parallelFor(relations.size(), [this, &writer](const size_t a_Index) {
+        generateRandomEdgePartitions<NodeId>(a_Index, writer);
+    });
+}
+
+template<typename NodeId>
+std::vector<std::vector<std::pair<NodeId, NodeId>>>
+GraphGenerator::generateRandomEdgeLists(const size_t a_RelationIndex) const {
+    const auto &relation = m_Config.getRelationDistributions()[a_RelationIndex];
+    const auto stubs = generateRelationStubs<NodeId>(relation, getRelationStream(a_RelationIndex));
+    if (stubs.m_NrOfEdges == 0) {
+        return {};
+    }
+    const auto partitions = getStubPartitions(stubs.m_FixedOffsets);
+    std::vector<std::vector<std::pair<NodeId, NodeId>>> edges(partitions.size());
+    m_ThreadPool.parallelFor(partitions.size(), [this, a_RelationIndex, &stubs, &partitions, &edges](
+            const size_t a_Partition) {
+        auto &partition_edges = edges[a_Partition];
+        pairStubs(a_RelationIndex, stubs, partitions[a_Partition].first, partitions[a_Partition].second,
+                  [&partition_edges](const NodeId a_Source, const NodeId a_Target) {
+                      partition_edges.emplace_back(a_Source, a_Target);
+                  });
+    });
+    return edges;
+}
+
+template<typename NodeId>
+void GraphGenerator::generateAdjacencies(OutputWriter &a_Writer) {
+    const auto &relations = m_Config.getRelationDistributions();
+    OutputBuffer buffer(&a_Writer);
+    buffer.appendLittleEndian(static_cast<uint32_t>(m_ReverseAdjacency ? 1 : 0));
+    for (size_t predicate_id = 0; predicate_id < m_Config.getNrOfPredicates(); ++predicate_id) {
+        std::vector<size_t> relation_indices;
+        for (size_t i = 0; i < relations.size(); ++i) {
+            if (m_PredicateIds[i] == predicate_id) {
+                relation_indices.push_back(i);
             }
         }
+        std::vector<std::vector<std::vector<std::pair<NodeId, NodeId>>>> relation_edges(relation_indices.size());
+        m_ThreadPool.parallelFor(relation_indices.size(), [this, &relation_indices, &relation_edges](
+                const size_t a_Index) {
+            relation_edges[a_Index] = generateRandomEdgeLists<NodeId>(relation_indices[a_Index]);
+        });
+        std::vector<std::vector<std::pair<NodeId, NodeId>>> edges;
+        for (auto &partitions : relation_edges) {
+            std::move(partitions.begin(), partitions.end(), std::back_inserter(edges));
+        }
+        relation_edges.clear();
+        writeAdjacency(buildAdjacency(edges, m_Config.getNrOfNodes(), false, m_ThreadPool), buffer);
+        if (m_ReverseAdjacency) {
+            writeAdjacency(buildAdjacency(edges, m_Config.getNrOfNodes(), true, m_ThreadPool), buffer);
+        }
     }
+    buffer.flush();
 }
 
-void GraphGenerator::generateGraph(std::ostream &a_OutputStream) {
-    a_OutputStream << "### NODE RELATIONS ###" << "\n";
-    for (const auto &relation : m_Config.getRelationDistributions()) {
-        generateRandomEdges(relation, a_OutputStream);
+template<typename NodeId>
+void GraphGenerator::writeAdjacency(const Adjacency<NodeId> &a_Adjacency, OutputBuffer &a_Buffer) const {
+    a_Buffer.appendLittleEndian(static_cast<uint64_t>(a_Adjacency.m_Neighbours.size()));
+    for (const uint64_t offset : a_Adjacency.m_Offsets) {
+        a_Buffer.appendLittleEndian(offset);
+    }
+    for (const NodeId neighbour : a_Adjacency.m_Neighbours) {
+        a_Buffer.appendLittleEndian(neighbour);
+    }
+}
+
+template<typename NodeId>
+void GraphGenerator::writeBinaryHeader(OutputWriter &a_Writer) const {
+    OutputBuffer buffer(&a_Writer);
+    if (m_Format == E_OUTPUT_FORMAT::CSR) {
+        buffer.append(m_AdjacencyMagic, sizeof(m_AdjacencyMagic));
+    } else {
+        buffer.append(m_BinaryMagic, sizeof(m_BinaryMagic));
+    }
+    buffer.appendLittleEndian(m_BinaryVersion);
+    buffer.appendLittleEndian(static_cast<uint32_t>(sizeof(NodeId)));
+    buffer.appendLittleEndian(static_cast<uint32_t>(m_Config.getNrOfPredicates()));
+    for (const auto &predicate : m_Config.getPredicates()) {
+        buffer.appendLittleEndian(static_cast<uint32_t>(predicate.size()));
+        buffer.append(predicate);
+    }
+    const auto types = m_Config.getTypeNames();
+    buffer.appendLittleEndian(static_cast<uint32_t>(types.size()));
+    for (const auto &type : types) {
+        const auto &range = m_Config.getTypeRange(type);
+        buffer.appendLittleEndian(static_cast<uint32_t>(type.size()));
+        buffer.append(type);
+        buffer.appendLittleEndian(range.first);
+        buffer.appendLittleEndian(range.second);
     }
+    buffer.flush();
 }
 
-GraphGenerator::GraphGenerator(const Configuration &a_Config)
-        : m_Config(a_Config) {}
+template<typename NodeId>
+void GraphGenerator::generateGraph(OutputWriter &a_Writer) {
+    if (m_Format == E_OUTPUT_FORMAT::TEXT) {
+        a_Writer.write("### NODE RELATIONS ###\n");
+        generateRelations<NodeId>(a_Writer);
+        return;
+    }
+    writeBinaryHeader<NodeId>(a_Writer);
+    if (m_Format == E_OUTPUT_FORMAT::CSR) {
+        generateAdjacencies<NodeId>(a_Writer);
+        return;
+    }
+    generateRelations<NodeId>(a_Writer);
+    // The number of edges is only known afterwards, so the records end with a record whose fields are all ones.
+    OutputBuffer buffer(&a_Writer);
+    for (size_t i = 0; i < 3; ++i) {
+        buffer.appendLittleEndian(std::numeric_limits<NodeId>::max());
+    }
+    buffer.flush();
+}
+
+template<typename NodeId>
+double GraphGenerator::measureSampleSeconds(const size_t a_RelationIndex, const double a_Fraction) const {
+    const auto &relation = m_Config.getRelationDistributions()[a_RelationIndex];
+    const auto &source_range = m_Config.getTypeRange(relation.getSource());
+    const auto &target_range = m_Config.getTypeRange(relation.getTarget());
+    const auto get_sample_size = [a_Fraction](const std::pair<uint64_t, uint64_t> &a_Range) {
+        const auto nr_nodes = static_cast<double>(a_Range.second - a_Range.first + 1);
+        return std::max(static_cast<uint64_t>(1), static_cast<uint64_t>(std::llround(nr_nodes * a_Fraction)));
+    };
+    // The sampled nodes are renumbered from 0. A relation within one type keeps a single range, so that loops are
+    // still recognised, and otherwise the target range follows the source range.
+    const std::pair<uint64_t, uint64_t> sample_sources(0, get_sample_size(source_range) - 1);
+    const uint64_t first_target = source_range == target_range ? 0 : sample_sources.second + 1;
+    const std::pair<uint64_t, uint64_t> sample_targets(first_target, first_target + get_sample_size(target_range) - 1);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto stubs = generateRelationStubs<NodeId>(relation, sample_sources, sample_targets,
+                                                     getRelationStream(a_RelationIndex).split("sample"));
+    if (stubs.m_NrOfEdges > 0) {
+        const size_t nr_fixed_nodes = stubs.m_FixedOffsets.size() - 1;
+        if (m_Format == E_OUTPUT_FORMAT::CSR) {
+            std::vector<std::vector<std::pair<NodeId, NodeId>>> edges(1);
+            pairStubs(a_RelationIndex, stubs, 0, nr_fixed_nodes, [&edges](const NodeId a_Source,
+                                                                         const NodeId a_Target) {
+                edges[0].emplace_back(a_Source, a_Target);
+            });
+            const uint64_t nr_nodes = std::max(sample_sources.second, sample_targets.second) + 1;
+            buildAdjacency(edges, nr_nodes, false, m_ThreadPool);
+            if (m_ReverseAdjacency) {
+                buildAdjacency(edges, nr_nodes, true, m_ThreadPool);
+            }
+        } else {
+            OutputBuffer buffer;
+            pairStubs(a_RelationIndex, stubs, 0, nr_fixed_nodes, getEdgeWriter<NodeId>(a_RelationIndex, buffer));
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+double GraphGenerator::measureSampleSeconds(const size_t a_RelationIndex, const double a_Fraction) const {
+    if (m_Config.getNrOfNodes() - 1 < std::numeric_limits<uint32_t>::max()) {
+        return measureSampleSeconds<uint32_t>(a_RelationIndex, a_Fraction);
+    }
+    return measureSampleSeconds<uint64_t>(a_RelationIndex, a_Fraction);
+}
+
+void GraphGenerator::generateGraph(OutputWriter &a_Writer) {
+    // The largest id of the type marks the end of the binary records, so it may not be the id of a node.
+    if (m_Config.getNrOfNodes() - 1 < std::numeric_limits<uint32_t>::max()) {
+        generateGraph<uint32_t>(a_Writer);
+    } else {
+        generateGraph<uint64_t>(a_Writer);
+    }
+}
+
+GraphGenerator::GraphGenerator(const Configuration &a_Config, ThreadPool &a_ThreadPool, const bool a_OrderedOutput,
+                               const bool a_StreamingEdges, const E_OUTPUT_FORMAT a_Format,
+                               const bool a_ReverseAdjacency)
+        : m_Config(a_Config),
+          m_ThreadPool(a_ThreadPool),
+          m_OrderedOutput(a_OrderedOutput),
+          m_StreamingEdges(a_StreamingEdges),
+          m_Format(a_Format),
+          m_ReverseAdjacency(a_ReverseAdjacency) {
+    const auto &predicates = m_Config.getPredicates();
+    for (const auto &relation : m_Config.getRelationDistributions()) {
+        const auto predicate = predicates.find(relation.getPredicate());
+        assert(predicate != predicates.end());
+        m_PredicateIds.push_back(static_cast<size_t>(std::distance(predicates.begin(), predicate)));
+    }
+}
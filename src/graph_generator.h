@@ -2,21 +2,166 @@
 #define GMARK_GRAPH_GENERATOR_H
 
 #include "configuration.h"
+#include "thread_pool.h"
+#include "random_permutation.h"
+#include "output_writer.h"
+#include "adjacency.h"
+#include "chunk_writer.h"
 
-std::vector<int>
-generateNodeDistributions(RandomDistribution *const a_Distribution, const int a_StartId, const int a_EndId);
+// Draws the degree of every node in [a_StartId, a_EndId] and returns their prefix sums, so that the stubs of the
+// i-th node are the stub indices [offsets[i], offsets[i + 1]).
+std::vector<size_t>
+generateNodeDegrees(RandomDistribution *const a_Distribution, const uint64_t a_StartId, const uint64_t a_EndId,
+                    const RandomStream &a_Stream, ThreadPool &a_ThreadPool);
+
+// Thins prefix-summed degrees whose total exceeds a_NrOfStubs to exactly a_NrOfStubs stubs by keeping a uniformly
+// random subset of the stubs, which preserves the shape of the degree distribution. The time is linear in the number
+// of nodes and kept stubs, so the surplus stubs are never visited, materialised or shuffled.
+void balanceNodeDegrees(std::vector<size_t> &a_Offsets, const size_t a_NrOfStubs, const RandomStream &a_Stream,
+                        ThreadPool &a_ThreadPool);
+
+// Expands prefix-summed degrees into one node id per stub.
+template<typename NodeId>
+std::vector<NodeId> generateNodeStubs(const std::vector<size_t> &a_Offsets, const NodeId a_StartId,
+                                      ThreadPool &a_ThreadPool);
+
+// The endpoint stubs of a relation. The side with more stubs is balanced to the stub total of the other side, which
+// is the number of edges. The fixed side is kept as prefix-summed degrees because its stubs are in node order. The
+// i-th fixed stub is paired with the i-th shuffled stub. Shuffled stubs are either materialised and shuffled, or, in
+// streaming mode, found on the fly by permuting the stub index and looking up the node that owns the permuted stub.
+// Streaming needs memory proportional to the number of nodes instead of the number of edges. NodeId is the type of
+// the materialised node ids.
+template<typename NodeId>
+struct RelationStubs {
+    std::vector<size_t> m_FixedOffsets;
+    NodeId m_FixedStartId = 0;
+    std::vector<NodeId> m_ShuffledNodes;
+    std::vector<size_t> m_ShuffledOffsets;
+    NodeId m_ShuffledStartId = 0;
+    FeistelPermutation m_ShuffledPermutation;
+    bool m_Streaming = false;
+    bool m_SourcesAreShuffled = false;
+    size_t m_NrOfEdges = 0;
+
+    NodeId getShuffledNode(const size_t a_Stub) const {
+        if (!m_Streaming) {
+            return m_ShuffledNodes[a_Stub];
+        }
+        const size_t stub = m_ShuffledPermutation(a_Stub);
+        const auto owner = std::upper_bound(m_ShuffledOffsets.begin(), m_ShuffledOffsets.end(), stub);
+        return m_ShuffledStartId + static_cast<NodeId>(std::distance(m_ShuffledOffsets.begin(), owner) - 1);
+    }
+};
 
 class GraphGenerator {
 protected:
+    // Relations with fewer edges than this are paired in a single partition.
+    static const size_t m_MinEdgesPerPartition;
+    // Larger relations get more partitions than the threads need, so that the output of a partition stays small.
+    static const size_t m_MaxEdgesPerPartition;
+    // The number of partitions per thread, so that partitions of uneven cost still balance out.
+    static const size_t m_PartitionsPerThread;
+    static const char m_BinaryMagic[8];
+    static const char m_AdjacencyMagic[8];
+    static const uint32_t m_BinaryVersion;
+
     const Configuration &m_Config;
+    ThreadPool &m_ThreadPool;
+    const bool m_OrderedOutput;
+    const bool m_StreamingEdges;
+    const E_OUTPUT_FORMAT m_Format;
+    const bool m_ReverseAdjacency;
+    // The id of the predicate of every relation, which is its index in the sorted set of predicates.
+    std::vector<size_t> m_PredicateIds;
 
-    void generateRandomEdges(const RelationDistribution &a_Relation,
-                             std::ostream &a_OutputStream) const;
+    RandomStream getRelationStream(const size_t a_RelationIndex) const {
+        return m_Config.getRandomStream().split("relations").split(a_RelationIndex);
+    }
 
-    void writeEdge(const int a_Source, const int a_Target, const std::string &a_Predicate,
-                   std::ostream &a_OutputStream) const {
-        // TODO: get unique ID of predicate instead.
-        a_OutputStream << a_Source << ',' << a_Predicate << ',' << a_Target << "\n";
+    template<typename NodeId>
+    RelationStubs<NodeId> generateRelationStubs(const RelationDistribution &a_Relation,
+                                                const RandomStream &a_Stream) const;
+
+    // Generates the stubs of the relation between the nodes of a_SourceRange and a_TargetRange instead of the
+    // ranges of its types.
+    template<typename NodeId>
+    RelationStubs<NodeId> generateRelationStubs(const RelationDistribution &a_Relation,
+                                                const std::pair<uint64_t, uint64_t> &a_SourceRange,
+                                                const std::pair<uint64_t, uint64_t> &a_TargetRange,
+                                                const RandomStream &a_Stream) const;
+
+    std::vector<std::pair<size_t, size_t>> getStubPartitions(const std::vector<size_t> &a_FixedOffsets) const;
+
+    // Pairs the stubs of the fixed nodes with index in [a_FirstNode, a_LastNode) and calls a_Sink(source, target)
+    // for every resulting edge, in the order of the fixed nodes.
+    template<typename NodeId, typename EdgeSink>
+    void pairStubs(const size_t a_RelationIndex, const RelationStubs<NodeId> &a_Stubs,
+                   const size_t a_FirstNode, const size_t a_LastNode, EdgeSink &&a_Sink) const;
+
+    // Returns an edge sink for pairStubs that writes the edges of the relation to a_Buffer.
+    template<typename NodeId>
+    auto getEdgeWriter(const size_t a_RelationIndex, OutputBuffer &a_Buffer) const {
+        const std::string &predicate = m_Config.getRelationDistributions()[a_RelationIndex].getPredicate();
+        const auto predicate_id = static_cast<NodeId>(m_PredicateIds[a_RelationIndex]);
+        return [this, &predicate, predicate_id, &a_Buffer](const NodeId a_Source, const NodeId a_Target) {
+            writeEdge(a_Source, a_Target, predicate, predicate_id, a_Buffer);
+        };
+    }
+
+    template<typename NodeId>
+    void generateRandomEdges(const size_t a_RelationIndex, OutputBuffer &a_Buffer) const;
+
+    // Splits the relation into partitions of fixed nodes that are paired concurrently and committed to a_Writer as
+    // chunks of their own, which are added after the chunks that a_Writer already has.
+    template<typename NodeId>
+    void generateRandomEdgePartitions(const size_t a_RelationIndex, ChunkWriter &a_Writer) const;
+
+    template<typename NodeId>
+    void generateRelations(OutputWriter &a_Writer);
+
+    // Collects the edges of the relation as (source, target) pairs, one list per partition.
+    template<typename NodeId>
+    std::vector<std::vector<std::pair<NodeId, NodeId>>> generateRandomEdgeLists(const size_t a_RelationIndex) const;
+
+    // Builds and writes the adjacency of every predicate in the order of the predicate dictionary. The edges of a
+    // predicate are kept in memory until its adjacency has been written.
+    template<typename NodeId>
+    void generateAdjacencies(OutputWriter &a_Writer);
+
+    template<typename NodeId>
+    void writeAdjacency(const Adjacency<NodeId> &a_Adjacency, OutputBuffer &a_Buffer) const;
+
+    // The binary format starts with the magic "PGMARKB\0", the format version and the width in bytes of the ids
+    // in the records, all little-endian. Then follow the predicate dictionary, whose ids are the indices in it, and
+    // the type dictionary with the first and last node id of every type. Strings are prefixed with their length.
+    // The edge records follow the header and end with a record whose bits are all set. The CSR format has the
+    // magic "PGMARKC\0" and the same header. Then follows a uint32 that is 1 when the reverse adjacencies are
+    // included and, per predicate, the uint64 number of edges, the uint64 offsets of all nodes plus one and the
+    // targets. With the reverse adjacencies, every predicate is followed by its offsets and sources by target.
+    template<typename NodeId>
+    void writeBinaryHeader(OutputWriter &a_Writer) const;
+
+    template<typename NodeId>
+    void generateGraph(OutputWriter &a_Writer);
+
+    template<typename NodeId>
+    double measureSampleSeconds(const size_t a_RelationIndex, const double a_Fraction) const;
+
+    template<typename NodeId>
+    void writeEdge(const NodeId a_Source, const NodeId a_Target, const std::string &a_Predicate,
+                   const NodeId a_PredicateId, OutputBuffer &a_Buffer) const {
+        if (m_Format == E_OUTPUT_FORMAT::BINARY) {
+            a_Buffer.appendLittleEndian(a_Source);
+            a_Buffer.appendLittleEndian(a_PredicateId);
+            a_Buffer.appendLittleEndian(a_Target);
+            return;
+        }
+        a_Buffer.appendInteger(a_Source);
+        a_Buffer.append(',');
+        a_Buffer.append(a_Predicate);
+        a_Buffer.append(',');
+        a_Buffer.appendInteger(a_Target);
+        a_Buffer.append('\n');
     }
 
 public:
@@ -24,9 +169,35 @@ public:
     GraphGenerator &operator=(const GraphGenerator &) = delete; // no copy operations.
     GraphGenerator(GraphGenerator &&) = delete; // no move operations.
     GraphGenerator &operator=(GraphGenerator &&) = delete; // no move operations.
-    explicit GraphGenerator(const Configuration &a_Config);
+    // With more than one thread the partitions of a relation are paired concurrently. When a_OrderedOutput is set
+    // the edges are written in the same order as a single-threaded run, otherwise the relations are generated
+    // concurrently as well and each partition is written once it is done.
+    // With a_StreamingEdges the shuffled stubs are never materialised, see RelationStubs. a_ReverseAdjacency adds
+    // the adjacencies by target to the CSR format.
+    GraphGenerator(const Configuration &a_Config, ThreadPool &a_ThreadPool, const bool a_OrderedOutput,
+                   const bool a_StreamingEdges, const E_OUTPUT_FORMAT a_Format, const bool a_ReverseAdjacency);
+
+    // The node ids are stored in 32 bits when the graph is small enough, which halves the size of the stub arrays.
+    // The binary format uses the same width for the node and predicate ids of its records, see writeBinaryHeader.
+    void generateGraph(OutputWriter &a_Writer);
+
+    // Generates the stubs of a_Fraction of the source and target nodes of the relation, pairs them and formats or
+    // places the edges like a run does, and returns the seconds that took. The sample is generated with the thread
+    // pool of the generator and its edges are discarded.
+    double measureSampleSeconds(const size_t a_RelationIndex, const double a_Fraction) const;
+
+    // The number of partitions that a relation with a_NrOfEdges edges is paired in.
+    static size_t getNrOfPartitions(const size_t a_NrOfEdges, const unsigned int a_NrOfThreads);
 
-    void generateGraph(std::ostream &a_OutputStream);
+    // The number of partitions whose output is held at the same time with ordered output.
+    static size_t getNrOfPartitionsPerWindow(const unsigned int a_NrOfThreads) {
+        return a_NrOfThreads * m_PartitionsPerThread;
+    }
+
+    // The most edges that a partition holds, unless a single fixed node has more stubs.
+    static size_t getMaxEdgesPerPartition() {
+        return m_MaxEdgesPerPartition;
+    }
 };
 
 #endif // GMARK_GRAPH_GENERATOR_H
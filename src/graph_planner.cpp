@@ -0,0 +1,237 @@
+#include "graph_planner.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include "unique_value_set.h"
+
+const size_t GraphPlanner::m_NrOfSamples = 1U << 12U;
+const size_t GraphPlanner::m_NrOfSampleEdges = 1U << 18U;
+const size_t GraphPlanner::m_NrOfSampleNodes = 1U << 18U;
+
+GraphPlanner::GraphPlanner(const Configuration &a_Config, const unsigned int a_NrOfThreads,
+                           const bool a_OrderedOutput, const E_OUTPUT_FORMAT a_Format, const bool a_StreamingEdges,
+                           const bool a_ReverseAdjacency)
+        : m_Config(a_Config),
+          m_NrOfThreads(a_NrOfThreads),
+          m_OrderedOutput(a_OrderedOutput),
+          m_Format(a_Format),
+          m_StreamingEdges(a_StreamingEdges),
+          m_ReverseAdjacency(a_ReverseAdjacency) {}
+
+Estimate GraphPlanner::estimateStubs(RandomDistribution *const a_Distribution, const uint64_t a_NrOfNodes) {
+    // The z-value of a two-sided 95% interval of the normal distribution.
+    constexpr double z_value = 1.96;
+    const auto nr_nodes = static_cast<double>(a_NrOfNodes);
+    Estimate estimate;
+    estimate.m_Expected = nr_nodes * std::max(a_Distribution->getMean(), 0.0);
+    const double deviation = std::sqrt(nr_nodes * a_Distribution->getVariance());
+    // An infinite mean comes with an infinite variance, so the lower bound is then 0.
+    estimate.m_Low = std::isfinite(deviation) ? std::max(estimate.m_Expected - z_value * deviation, 0.0) : 0.0;
+    estimate.m_High = estimate.m_Expected + z_value * deviation;
+    return estimate;
+}
+
+std::string GraphPlanner::formatValue(const double a_Value, const int a_Precision) {
+    if (std::isinf(a_Value)) {
+        return "unbounded";
+    }
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(a_Precision) << a_Value;
+    return stream.str();
+}
+
+double GraphPlanner::getAverageDigits(const uint64_t a_First, const uint64_t a_Last) {
+    assert(a_First <= a_Last);
+    double total_digits = 0.0;
+    uint64_t power = 1;
+    for (unsigned int digits = 1; digits <= std::numeric_limits<uint64_t>::digits10 + 1; ++digits) {
+        // The integers with this many digits are [power, power * 10), and [0, 10) for one digit.
+        const uint64_t low = digits == 1 ? 0 : power;
+        const bool is_last = power > std::numeric_limits<uint64_t>::max() / 10;
+        const uint64_t high = is_last ? std::numeric_limits<uint64_t>::max() : power * 10 - 1;
+        if (a_First <= high && low <= a_Last) {
+            const uint64_t count = std::min(high, a_Last) - std::max(low, a_First) + 1;
+            total_digits += static_cast<double>(digits) * static_cast<double>(count);
+        }
+        if (is_last) {
+            break;
+        }
+        power *= 10;
+    }
+    return total_digits / (static_cast<double>(a_Last - a_First) + 1.0);
+}
+
+double GraphPlanner::measureRelationSeconds(const GraphGenerator &a_Generator, const size_t a_RelationIndex,
+                                            const double a_NrOfEdges, const uint64_t a_NrOfNodes) const {
+    if (std::isinf(a_NrOfEdges)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    const double fraction = std::min({1.0, static_cast<double>(m_NrOfSampleEdges) / a_NrOfEdges,
+                                      static_cast<double>(m_NrOfSampleNodes) / static_cast<double>(a_NrOfNodes)});
+    return a_Generator.measureSampleSeconds(a_RelationIndex, fraction) / fraction;
+}
+
+void GraphPlanner::printPlan(std::ostream &a_Stream) const {
+    constexpr double megabyte = 1e6;
+    const auto id_width = static_cast<double>(getIdWidth());
+    const auto nr_nodes = static_cast<double>(m_Config.getNrOfNodes());
+    a_Stream << "Nodes: " << m_Config.getNrOfNodes() << "\n";
+    for (const auto &type : m_Config.getTypeNames()) {
+        const auto &range = m_Config.getTypeRange(type);
+        a_Stream << "Type " << type << ": nodes [" << range.first << ", " << range.second << "]\n";
+    }
+
+    // The samples are generated on a single thread. The run time of a relation is then divided by the number of
+    // threads that its partitions keep busy, or with unordered output by the number that all partitions keep busy.
+    ThreadPool sample_thread_pool(1);
+    const GraphGenerator graph_generator(m_Config, sample_thread_pool, m_OrderedOutput, m_StreamingEdges, m_Format,
+                                         m_ReverseAdjacency);
+    const auto &relations = m_Config.getRelationDistributions();
+    double relation_seconds = 0.0;
+    double relation_thread_seconds = 0.0;
+    size_t nr_partitions = 0;
+    Estimate edge_bytes;
+    std::vector<double> relation_memory;
+    std::map<std::string, double> predicate_edges;
+    for (size_t i = 0; i < relations.size(); ++i) {
+        const auto &relation = relations[i];
+        const auto &source_range = m_Config.getTypeRange(relation.getSource());
+        const auto &target_range = m_Config.getTypeRange(relation.getTarget());
+        const uint64_t nr_sources = source_range.second - source_range.first + 1;
+        const uint64_t nr_targets = target_range.second - target_range.first + 1;
+        const Estimate out_stubs = estimateStubs(relation.getOutDistribution(), nr_sources);
+        const Estimate in_stubs = estimateStubs(relation.getInDistribution(), nr_targets);
+        Estimate edges;
+        edges.m_Expected = std::min(out_stubs.m_Expected, in_stubs.m_Expected);
+        edges.m_Low = std::min(out_stubs.m_Low, in_stubs.m_Low);
+        edges.m_High = std::min(out_stubs.m_High, in_stubs.m_High);
+        predicate_edges[relation.getPredicate()] += edges.m_Expected;
+
+        double bytes_per_edge = 3.0 * id_width;
+        if (m_Format == E_OUTPUT_FORMAT::TEXT) {
+            bytes_per_edge = getAverageDigits(source_range.first, source_range.second) +
+                             static_cast<double>(relation.getPredicate().size()) +
+                             getAverageDigits(target_range.first, target_range.second) + 3.0;
+        } else if (m_Format == E_OUTPUT_FORMAT::CSR) {
+            bytes_per_edge = m_ReverseAdjacency ? 2.0 * id_width : id_width;
+        }
+        edge_bytes.m_Expected += edges.m_Expected * bytes_per_edge;
+        edge_bytes.m_Low += edges.m_Low * bytes_per_edge;
+        edge_bytes.m_High += edges.m_High * bytes_per_edge;
+
+        // The degree arrays of both sides, the stubs and the scratch space of the shuffle, and the output of the
+        // partitions that are held at the same time with more than one thread.
+        double memory = 8.0 * static_cast<double>(nr_sources + nr_targets);
+        if (!m_StreamingEdges) {
+            memory += edges.m_Expected * (2.0 * id_width + 2.0);
+        }
+        if (m_Format == E_OUTPUT_FORMAT::CSR) {
+            memory += edges.m_Expected * 2.0 * id_width;
+        } else if (m_NrOfThreads > 1) {
+            const size_t nr_held_partitions = m_OrderedOutput
+                                              ? GraphGenerator::getNrOfPartitionsPerWindow(m_NrOfThreads)
+                                              : m_NrOfThreads;
+            const auto held_edges = static_cast<double>(nr_held_partitions *
+                                                        GraphGenerator::getMaxEdgesPerPartition());
+            memory += std::min(edges.m_Expected, held_edges) * bytes_per_edge;
+        }
+        relation_memory.push_back(memory);
+
+        const double seconds = measureRelationSeconds(graph_generator, i, edges.m_Expected,
+                                                      std::max(nr_sources, nr_targets));
+        const size_t relation_partitions = std::isinf(edges.m_Expected)
+                                           ? m_NrOfThreads
+                                           : GraphGenerator::getNrOfPartitions(
+                                                   static_cast<size_t>(edges.m_Expected), m_NrOfThreads);
+        relation_seconds += seconds / static_cast<double>(std::min<size_t>(m_NrOfThreads, relation_partitions));
+        relation_thread_seconds += seconds;
+        nr_partitions += relation_partitions;
+
+        a_Stream << "Relation " << relation.getSource() << " -" << relation.getPredicate() << "-> "
+                 << relation.getTarget() << ": " << formatValue(edges.m_Expected, 0) << " edges (95%: "
+                 << formatValue(edges.m_Low, 0) << " to " << formatValue(edges.m_High, 0) << "), "
+                 << formatValue(out_stubs.m_Expected, 0) << " out-stubs, " << formatValue(in_stubs.m_Expected, 0)
+                 << " in-stubs\n";
+    }
+
+    double adjacency_memory = 0.0;
+    if (m_Format == E_OUTPUT_FORMAT::CSR) {
+        // Every predicate holds its edge pairs twice while they are placed, and the adjacency.
+        const double nr_adjacencies = m_ReverseAdjacency ? 2.0 : 1.0;
+        edge_bytes.m_Expected += static_cast<double>(m_Config.getNrOfPredicates()) * nr_adjacencies * 8.0 * nr_nodes;
+        edge_bytes.m_Low += static_cast<double>(m_Config.getNrOfPredicates()) * nr_adjacencies * 8.0 * nr_nodes;
+        edge_bytes.m_High += static_cast<double>(m_Config.getNrOfPredicates()) * nr_adjacencies * 8.0 * nr_nodes;
+        for (const auto &predicate : predicate_edges) {
+            adjacency_memory = std::max(adjacency_memory, predicate.second * (5.0 * id_width) + 8.0 * nr_nodes);
+        }
+    }
+
+    double attribute_bytes = 0.0;
+    double attribute_seconds = 0.0;
+    size_t nr_attribute_chunks = 0;
+    double unique_memory = 0.0;
+    AttributeValues values;
+    OutputBuffer lines;
+    for (const auto &type : m_Config.getTypeNames()) {
+        const auto &range = m_Config.getTypeRange(type);
+        const auto nr_type_nodes = static_cast<double>(range.second - range.first + 1);
+        const double id_digits = getAverageDigits(range.first, range.second);
+        for (const auto &attribute : m_Config.getTypeAttributes(type)) {
+            // The values are generated and formatted like the attribute generator does, in blocks of nodes.
+            nr_attribute_chunks += (range.second - range.first) / RandomStream::m_NodesPerStream + 1;
+            RandomStream generator = m_Config.getRandomStream().split("plan");
+            const auto start = std::chrono::steady_clock::now();
+            values.clear();
+            attribute->appendRandomAttributes(generator, generator, 0, m_NrOfSamples, values);
+            for (size_t offset = 0; offset < values.getCount(); ++offset) {
+                lines.appendInteger(range.first + offset);
+                lines.append(',');
+                lines.append(attribute->getName());
+                lines.append(',');
+                lines.append(values.getValue(offset), values.getLength(offset));
+                lines.append('\n');
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            const double value_length = static_cast<double>(values.getData().size()) / m_NrOfSamples;
+            attribute_bytes += nr_type_nodes * (id_digits + static_cast<double>(attribute->getName().size()) +
+                                                value_length + 3.0);
+            attribute_seconds += nr_type_nodes * elapsed.count() / m_NrOfSamples;
+            if (attribute->isUnique() && !attribute->hasDistinctValues(range.second - range.first + 1)) {
+                unique_memory = std::max(unique_memory,
+                                         UniqueValueSet::getExpectedBytes(range.second - range.first + 1));
+            }
+        }
+    }
+
+    // Unordered relations are generated concurrently, so the largest ones may be in memory at the same time.
+    std::sort(relation_memory.begin(), relation_memory.end(), std::greater<double>());
+    const size_t nr_concurrent_relations = m_OrderedOutput ? 1 : m_NrOfThreads;
+    double peak_memory = static_cast<double>(OutputBuffer::m_WriterCapacity);
+    for (size_t i = 0; i < relation_memory.size() && i < nr_concurrent_relations; ++i) {
+        peak_memory += relation_memory[i];
+    }
+    peak_memory += adjacency_memory;
+    // The attributes are generated after the edges, and the values of one unique attribute are checked at a time.
+    peak_memory = std::max(peak_memory, static_cast<double>(OutputBuffer::m_WriterCapacity) + unique_memory);
+
+    a_Stream << "Output of the relations: " << formatValue(edge_bytes.m_Expected / megabyte, 1) << " MB (95%: "
+             << formatValue(edge_bytes.m_Low / megabyte, 1) << " to " << formatValue(edge_bytes.m_High / megabyte, 1)
+             << " MB)\n";
+    a_Stream << "Output of the attributes: " << formatValue(attribute_bytes / megabyte, 1) << " MB\n";
+    a_Stream << "Output in total: " << formatValue((edge_bytes.m_Expected + attribute_bytes) / megabyte, 1) << " MB\n";
+    a_Stream << "Peak memory: " << formatValue(peak_memory / megabyte, 1) << " MB\n";
+    if (!m_OrderedOutput && m_Format != E_OUTPUT_FORMAT::CSR) {
+        relation_seconds = relation_thread_seconds /
+                           static_cast<double>(std::max<size_t>(std::min<size_t>(m_NrOfThreads, nr_partitions), 1));
+    }
+    attribute_seconds /= static_cast<double>(std::max<size_t>(std::min<size_t>(m_NrOfThreads, nr_attribute_chunks),
+                                                              1));
+    a_Stream << "Run time: " << formatValue(relation_seconds + attribute_seconds, 1) << " s with "
+             << m_NrOfThreads
+             << (m_NrOfThreads == 1 ? " thread" : " threads") << ", not counting the output device\n";
+}
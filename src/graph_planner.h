@@ -0,0 +1,66 @@
+#ifndef GMARK_GRAPH_PLANNER_H
+#define GMARK_GRAPH_PLANNER_H
+
+#include <ostream>
+#include <string>
+#include "configuration.h"
+#include "graph_generator.h"
+#include "output_writer.h"
+
+// An expected value with approximate 95% bounds.
+struct Estimate {
+    double m_Expected = 0.0;
+    double m_Low = 0.0;
+    double m_High = 0.0;
+};
+
+// Predicts what a run with the given configuration costs without generating the graph. The numbers of stubs and
+// edges follow from the means and variances of the degree distributions: the stub total of a type is a sum of
+// independent degrees, which is close to normal for large types. An infinite variance gives an unbounded upper
+// bound, and an infinite mean an unbounded expectation. Edge counts are upper bounds, because the edges that are
+// removed as loops or parallel edges are not predicted. Value lengths of attributes are measured on a few thousand
+// samples. The run time of a relation is measured by generating, shuffling, pairing and formatting a sample of a
+// few hundred thousand edges with the code of the generator, and the run time of the attributes on a few thousand
+// values, which takes about a second in total. The run time leaves out the speed of the output device.
+class GraphPlanner {
+protected:
+    static const size_t m_NrOfSamples;
+    static const size_t m_NrOfSampleEdges;
+    static const size_t m_NrOfSampleNodes;
+
+    const Configuration &m_Config;
+    const unsigned int m_NrOfThreads;
+    const bool m_OrderedOutput;
+    const E_OUTPUT_FORMAT m_Format;
+    const bool m_StreamingEdges;
+    const bool m_ReverseAdjacency;
+
+    static Estimate estimateStubs(RandomDistribution *const a_Distribution, const uint64_t a_NrOfNodes);
+
+    // a_Value with a_Precision decimals, or "unbounded" when it is infinite.
+    static std::string formatValue(const double a_Value, const int a_Precision);
+
+    // The average number of decimal digits of the integers in [a_First, a_Last].
+    static double getAverageDigits(const uint64_t a_First, const uint64_t a_Last);
+
+    // The seconds that a_Generator takes to generate the relation on one thread, extrapolated from a sample of at
+    // most about m_NrOfSampleEdges edges and m_NrOfSampleNodes nodes of each side.
+    double measureRelationSeconds(const GraphGenerator &a_Generator, const size_t a_RelationIndex,
+                                  const double a_NrOfEdges, const uint64_t a_NrOfNodes) const;
+
+    size_t getIdWidth() const {
+        return m_Config.getNrOfNodes() - 1 < std::numeric_limits<uint32_t>::max() ? sizeof(uint32_t)
+                                                                                 : sizeof(uint64_t);
+    }
+
+public:
+    GraphPlanner(const GraphPlanner &) = delete; // no copy operations.
+    GraphPlanner &operator=(const GraphPlanner &) = delete; // no copy operations.
+
+    GraphPlanner(const Configuration &a_Config, const unsigned int a_NrOfThreads, const bool a_OrderedOutput,
+                 const E_OUTPUT_FORMAT a_Format, const bool a_StreamingEdges, const bool a_ReverseAdjacency);
+
+    void printPlan(std::ostream &a_Stream) const;
+};
+
+#endif //GMARK_GRAPH_PLANNER_H
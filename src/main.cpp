@@ -1,7 +1,9 @@
 #include "main.h"
 #include "graph_generator.h"
 #include "node_attribute_generator.h"
-#include <fstream>
+#include "thread_pool.h"
+#include "output_writer.h"
+#include "graph_planner.h"
 #include <getopt.h>
 #include <sys/stat.h>
 
@@ -9,16 +11,31 @@ int main(int argc, char *argv[]) {
     std::ios_base::sync_with_stdio(false);
     std::ostream::sync_with_stdio(false); // On some platforms, stdout flushes on \n.
     std::string graph_file;
+    int nr_of_threads = 1;
+    bool has_seed = false;
+    uint64_t seed = 0;
+    bool ordered_output = true;
+    bool streaming_edges = false;
+    E_OUTPUT_FORMAT output_format = E_OUTPUT_FORMAT::TEXT;
+    bool reverse_adjacency = false;
+    bool plan_only = false;
 
     while (true) {
         int option_index = 0;
         static struct option long_options[] = {
-                {"output", required_argument, nullptr, 'o'},
-                {"help",   no_argument,       nullptr, 'h'},
-                {nullptr,  0,                 nullptr, 0}
+                {"output",    required_argument, nullptr, 'o'},
+                {"threads",   required_argument, nullptr, 't'},
+                {"unordered", no_argument,       nullptr, 'u'},
+                {"seed",      required_argument, nullptr, 's'},
+                {"streaming", no_argument,       nullptr, 'm'},
+                {"format",    required_argument, nullptr, 'f'},
+                {"reverse",   no_argument,       nullptr, 'r'},
+                {"plan",      no_argument,       nullptr, 'p'},
+                {"help",      no_argument,       nullptr, 'h'},
+                {nullptr,     0,                 nullptr, 0}
         };
 
-        int c = getopt_long_only(argc, argv, "o:h",
+        int c = getopt_long_only(argc, argv, "o:t:us:mf:rph",
                              long_options, &option_index);
         if (c == -1) {
             break;
@@ -28,13 +45,75 @@ int main(int argc, char *argv[]) {
             case 'o':
                 graph_file = std::string(optarg);
                 break;
+            case 't':
+                try {
+                    nr_of_threads = std::stoi(optarg);
+                }
+                catch (std::logic_error &) {
+                    std::cout << "Please input a valid number of threads.\n";
+                    exit(EXIT_FAILURE);
+                }
+                if (nr_of_threads <= 0) {
+                    std::cout << "Please input a number of threads that is > 0.\n";
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'u':
+                ordered_output = false;
+                break;
+            case 's':
+                try {
+                    seed = std::stoull(optarg);
+                }
+                catch (std::logic_error &) {
+                    std::cout << "Please input a valid unsigned 64-bit number for the seed.\n";
+                    exit(EXIT_FAILURE);
+                }
+                has_seed = true;
+                break;
+            case 'm':
+                streaming_edges = true;
+                break;
+            case 'f':
+                if (std::string(optarg) == "text") {
+                    output_format = E_OUTPUT_FORMAT::TEXT;
+                } else if (std::string(optarg) == "binary") {
+                    output_format = E_OUTPUT_FORMAT::BINARY;
+                } else if (std::string(optarg) == "csr") {
+                    output_format = E_OUTPUT_FORMAT::CSR;
+                } else {
+                    std::cout << "Please input a valid output format: text, binary or csr.\n";
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'r':
+                reverse_adjacency = true;
+                break;
+            case 'p':
+                plan_only = true;
+                break;
             case 'h':
                 std::cout << "Usage: pgMark [OPTION]... SCHEMA_FILE.\n";
                 std::cout << "Generate a graph according to a specified SCHEMA_FILE.\n";
                 std::cout << "\n";
                 std::cout << "Mandatory arguments to long options are mandatory for short options too.\n";
-                std::cout << "-o, --output=FILE  the optional output file.\n";
-                std::cout << "-h, --help         display this help and exit.\n";
+                std::cout << "-o, --output=FILE   the optional output file.\n";
+                std::cout << "-t, --threads=N     generate the relations and attributes with N threads (default 1).\n";
+                std::cout << "-u, --unordered     with more than one thread, generate the relations concurrently and\n";
+                std::cout << "                    write the edges as soon as they are done instead of in schema order.\n";
+                std::cout << "-s, --seed=SEED     seed the generator, so that runs with the same schema, size and\n";
+                std::cout << "                    seed give the same graph regardless of the number of threads.\n";
+                std::cout << "-m, --streaming     pair the edge endpoints on the fly with memory proportional to the\n";
+                std::cout << "                    number of nodes instead of the number of edges.\n";
+                std::cout << "-f, --format=FORMAT write the edges as text (default) or binary, which is a header with\n";
+                std::cout << "                    the predicate and type dictionaries followed by fixed-width\n";
+                std::cout << "                    little-endian (source, predicate id, target) records, or csr, which\n";
+                std::cout << "                    is the same header followed by the adjacency of every predicate in\n";
+                std::cout << "                    compressed sparse row form.\n";
+                std::cout << "-r, --reverse       with --format=csr, also write the adjacencies by target.\n";
+                std::cout << "-p, --plan          predict the numbers of edges, the output size, the peak memory and\n";
+                std::cout << "                    the run time of the other options without generating the graph.\n";
+                std::cout << "-h, --help          display this help and exit.\n";
                 exit(EXIT_SUCCESS);
             default:
                 exit(EXIT_FAILURE);
@@ -51,16 +130,16 @@ int main(int argc, char *argv[]) {
         std::cout << "Missing graph size!\n";
         exit(EXIT_FAILURE);
     }
-    int graphSize = 0;
+    long long graphSize = 0;
     try {
-        graphSize = std::stoi(argv[optind++]);
+        graphSize = std::stoll(argv[optind++]);
     }
     catch (std::invalid_argument &) {
         std::cout << "Please input a valid number for the graph size.\n";
         exit(EXIT_FAILURE);
     }
     catch (std::out_of_range &) {
-        std::cout << "Please input a graph size within a 32-bit integer range.\n";
+        std::cout << "Please input a graph size within a 64-bit integer range.\n";
         exit(EXIT_FAILURE);
     }
     if (graphSize <= 0) {
@@ -78,30 +157,43 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    if (reverse_adjacency && output_format != E_OUTPUT_FORMAT::CSR) {
+        std::cout << "The reverse adjacencies can only be written with --format=csr.\n";
+        exit(EXIT_FAILURE);
+    }
+
     if (!checkFileExists(conf_file)) {
         std::cout << "The given schema file does not exist.\n";
         exit(EXIT_FAILURE);
     }
 
-    Configuration config(conf_file, graphSize);
+    if (!has_seed) {
+        std::random_device random_device;
+        seed = (static_cast<uint64_t>(random_device()) << 32U) ^ static_cast<uint64_t>(random_device());
+    }
+
+    ThreadPool thread_pool(static_cast<unsigned int>(nr_of_threads));
+    Configuration config(conf_file, static_cast<uint64_t>(graphSize), seed, thread_pool);
 
-    std::streambuf *buf;
-    std::ofstream output_file;
-    if (graph_file.empty()) {
-        buf = std::cout.rdbuf();
-    } else {
-        output_file.open(graph_file);
-        buf = output_file.rdbuf();
+    if (plan_only) {
+        // The writer is not created, as it would truncate the output file.
+        GraphPlanner planner(config, static_cast<unsigned int>(nr_of_threads), ordered_output, output_format,
+                             streaming_edges, reverse_adjacency);
+        planner.printPlan(std::cout);
+        exit(EXIT_SUCCESS);
     }
 
-    std::ostream graph_stream(buf);
-    buf = nullptr;
+    OutputWriter writer(graph_file);
+
+    GraphGenerator generator(config, thread_pool, ordered_output, streaming_edges, output_format,
+                             reverse_adjacency);
+    generator.generateGraph(writer);
 
-    GraphGenerator generator(config);
-    generator.generateGraph(graph_stream);
+    NodeAttributeGenerator attributeGenerator(config, thread_pool);
+    attributeGenerator.generateAttributes(writer);
 
-    NodeAttributeGenerator attributeGenerator(config);
-    attributeGenerator.generateAttributes(graph_stream);
+    std::cerr << "Wrote " << static_cast<double>(writer.getBytesWritten()) / 1e6 << " MB in "
+              << writer.getElapsedSeconds() << " s (" << writer.getThroughput() << " MB/s).\n";
 }
 
 bool checkFileExists(const std::string &a_Name) {
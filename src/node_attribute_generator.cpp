@@ -1,31 +1,193 @@
 #include "node_attribute_generator.h"
+#include <algorithm>
+#include <numeric>
 
-void NodeAttributeGenerator::generateAttributes(std::ostream &a_OutputStream) {
-    for (const auto &type : m_Config.getTypeNames()) {
-        generateRandomAttributes(type, a_OutputStream);
+const uint64_t NodeAttributeGenerator::m_BlocksPerWindow = 16;
+const unsigned int NodeAttributeGenerator::m_MaxRedraws = 1000;
+
+void NodeAttributeGenerator::generateAttributes(OutputWriter &a_Writer) {
+    const auto type_names = m_Config.getTypeNames();
+    const auto chunks = getAttributeChunks(type_names);
+    // The blocks of an attribute that needs a uniqueness check are generated on their own. The other chunks are
+    // generated in runs, which may span several attributes and types. All runs share one chunk writer, so the
+    // buffers of the chunks that are written are reused by the chunks after them.
+    ChunkWriter writer(a_Writer, 0, true);
+    size_t first = 0;
+    while (first < chunks.size()) {
+        const bool check_uniqueness = needsUniquenessCheck(chunks[first]);
+        size_t last = first + 1;
+        while (last < chunks.size() && (check_uniqueness ? chunks[last].m_Block != 0
+                                                         : !needsUniquenessCheck(chunks[last]))) {
+            ++last;
+        }
+        if (check_uniqueness) {
+            generateUniqueChunks(chunks, first, last, writer);
+        } else {
+            generateChunks(chunks, first, last, writer);
+        }
+        first = last;
     }
 }
 
-void NodeAttributeGenerator::generateRandomAttributes(const std::string &a_TypeName,
-                                                      std::ostream &a_OutputStream) const {
-    const auto &attributes = m_Config.getTypeAttributes(a_TypeName);
-    if (!attributes.empty()) {
-        const auto &type_range = m_Config.getTypeRange(a_TypeName);
-        a_OutputStream << "### NODE ATTRIBUTES ###" << "\n";
-        for (const auto &attribute : attributes) {
-            generateNodeAttributes(attribute, type_range.first, type_range.second, a_OutputStream);
+std::vector<NodeAttributeGenerator::AttributeChunk>
+NodeAttributeGenerator::getAttributeChunks(const std::vector<std::string> &a_TypeNames) const {
+    std::vector<AttributeChunk> chunks;
+    for (const auto &type : a_TypeNames) {
+        const uint64_t nr_blocks = (getNrOfNodes(type) - 1) / RandomStream::m_NodesPerStream + 1;
+        for (size_t i = 0; i < m_Config.getTypeAttributes(type).size(); ++i) {
+            for (uint64_t block = 0; block < nr_blocks; ++block) {
+                chunks.push_back({&type, i, block});
+            }
         }
     }
+    return chunks;
+}
+
+bool NodeAttributeGenerator::needsUniquenessCheck(const AttributeChunk &a_Chunk) const {
+    const auto &attribute = getAttribute(a_Chunk);
+    return attribute->isUnique() && !attribute->hasDistinctValues(getNrOfNodes(*a_Chunk.m_TypeName));
+}
+
+RandomStream NodeAttributeGenerator::getAttributeStream(const AttributeChunk &a_Chunk) const {
+    return m_Config.getRandomStream().split("attributes").split(*a_Chunk.m_TypeName).split(a_Chunk.m_AttributeIndex);
+}
+
+void NodeAttributeGenerator::generateAttributeValues(const AttributeChunk &a_Chunk, AttributeValues &a_Values) const {
+    const uint64_t nr_nodes = getNrOfNodes(*a_Chunk.m_TypeName);
+    const RandomStream attribute_stream = getAttributeStream(a_Chunk);
+    RandomStream generator = attribute_stream.split(a_Chunk.m_Block);
+    const uint64_t first = a_Chunk.m_Block * RandomStream::m_NodesPerStream;
+    const uint64_t last = std::min(first + RandomStream::m_NodesPerStream, nr_nodes);
+    assert(first < last);
+    a_Values.clear();
+    getAttribute(a_Chunk)->appendRandomAttributes(generator, attribute_stream.split("unique"), first, last - first,
+                                                  a_Values);
+    assert(a_Values.getCount() == last - first);
 }
 
-void NodeAttributeGenerator::generateNodeAttributes(const std::unique_ptr<Attribute> &a_Attribute, const int a_StartId,
-                                                    const int a_EndId, std::ostream &a_OutputStream) const {
-    int amount = a_EndId - a_StartId + 1;
-    auto &attribute_name = a_Attribute->getName();
-    assert(amount > 0);
+void NodeAttributeGenerator::appendAttributeLines(const AttributeChunk &a_Chunk, const AttributeValues &a_Values,
+                                                  OutputBuffer &a_Buffer) const {
+    const auto &attribute_name = getAttribute(a_Chunk)->getName();
     assert(!attribute_name.empty());
-    for (int node_id = a_StartId; node_id <= a_EndId; ++node_id) {
-        std::string random_attribute = a_Attribute->getRandomAttribute();
-        a_OutputStream << node_id << ',' << attribute_name << ',' << random_attribute << "\n";
+    if (a_Chunk.m_AttributeIndex == 0 && a_Chunk.m_Block == 0) {
+        a_Buffer.append("### NODE ATTRIBUTES ###\n");
+    }
+    const uint64_t first_node = m_Config.getTypeRange(*a_Chunk.m_TypeName).first +
+                                a_Chunk.m_Block * RandomStream::m_NodesPerStream;
+    for (size_t offset = 0; offset < a_Values.getCount(); ++offset) {
+        a_Buffer.appendInteger(first_node + offset);
+        a_Buffer.append(',');
+        a_Buffer.append(attribute_name);
+        a_Buffer.append(',');
+        a_Buffer.append(a_Values.getValue(offset), a_Values.getLength(offset));
+        a_Buffer.append('\n');
+    }
+}
+
+void NodeAttributeGenerator::generateChunks(const std::vector<AttributeChunk> &a_Chunks, const size_t a_First,
+                                            const size_t a_Last, ChunkWriter &a_Writer) {
+    // The chunk writer puts the chunks back in order, so the output is the same as with a single thread.
+    const size_t first_chunk = a_Writer.addChunks(a_Last - a_First);
+    m_ThreadPool.parallelFor(a_Last - a_First, [this, &a_Chunks, a_First, &a_Writer,
+                                                first_chunk](const size_t a_Index) {
+        // The values of a thread keep their memory from one chunk to the next.
+        thread_local AttributeValues values;
+        OutputBuffer buffer = a_Writer.getBuffer();
+        generateAttributeValues(a_Chunks[a_First + a_Index], values);
+        appendAttributeLines(a_Chunks[a_First + a_Index], values, buffer);
+        a_Writer.commit(first_chunk + a_Index, std::move(buffer));
+    });
+}
+
+void NodeAttributeGenerator::generateUniqueChunks(const std::vector<AttributeChunk> &a_Chunks, const size_t a_First,
+                                                  const size_t a_Last, ChunkWriter &a_Writer) {
+    const size_t nr_shards = UniqueValueSet::getNrOfShards();
+    UniqueValueSet set(getNrOfNodes(*a_Chunks[a_First].m_TypeName));
+    std::vector<UniqueBlock> blocks(std::min<size_t>(m_BlocksPerWindow, a_Last - a_First));
+    for (size_t window = a_First; window < a_Last; window += m_BlocksPerWindow) {
+        const size_t nr_blocks = std::min<size_t>(m_BlocksPerWindow, a_Last - window);
+        m_ThreadPool.parallelFor(nr_blocks, [this, &a_Chunks, window, nr_shards, &blocks](const size_t a_Index) {
+            UniqueBlock &block = blocks[a_Index];
+            generateAttributeValues(a_Chunks[window + a_Index], block.m_Values);
+            // Group the offsets by shard with a counting sort, which keeps them in node order.
+            const size_t nr_values = block.m_Values.getCount();
+            block.m_Fingerprints.resize(nr_values);
+            block.m_ShardStarts.assign(nr_shards + 1, 0);
+            for (size_t offset = 0; offset < nr_values; ++offset) {
+                const uint64_t fingerprint = UniqueValueSet::getFingerprint(
+                        {block.m_Values.getValue(offset), block.m_Values.getLength(offset)});
+                block.m_Fingerprints[offset] = fingerprint;
+                ++block.m_ShardStarts[UniqueValueSet::getShard(fingerprint) + 1];
+            }
+            std::partial_sum(block.m_ShardStarts.begin(), block.m_ShardStarts.end(), block.m_ShardStarts.begin());
+            block.m_NextOffsets.assign(block.m_ShardStarts.begin(), block.m_ShardStarts.end() - 1);
+            block.m_ShardOffsets.resize(nr_values);
+            for (size_t offset = 0; offset < nr_values; ++offset) {
+                const size_t shard = UniqueValueSet::getShard(block.m_Fingerprints[offset]);
+                block.m_ShardOffsets[block.m_NextOffsets[shard]++] = static_cast<uint32_t>(offset);
+            }
+            block.m_IsRepeated.assign(nr_values, 0);
+        });
+
+        // Every shard sees its values in node order, so the first node with a value keeps it.
+        m_ThreadPool.parallelFor(nr_shards, [nr_blocks, &blocks, &set](const size_t a_Shard) {
+            for (size_t i = 0; i < nr_blocks; ++i) {
+                UniqueBlock &block = blocks[i];
+                for (size_t j = block.m_ShardStarts[a_Shard]; j < block.m_ShardStarts[a_Shard + 1]; ++j) {
+                    const uint32_t offset = block.m_ShardOffsets[j];
+                    if (!set.insert(block.m_Fingerprints[offset])) {
+                        block.m_IsRepeated[offset] = 1;
+                    }
+                }
+            }
+        });
+
+        // Repeated values are rare for attributes that can be unique, so they are redrawn on a single thread.
+        for (size_t i = 0; i < nr_blocks; ++i) {
+            redrawRepeatedValues(a_Chunks[window + i], blocks[i], set);
+        }
+
+        const size_t first_chunk = a_Writer.addChunks(nr_blocks);
+        m_ThreadPool.parallelFor(nr_blocks, [this, &a_Chunks, window, &blocks, &a_Writer,
+                                             first_chunk](const size_t a_Index) {
+            OutputBuffer buffer = a_Writer.getBuffer();
+            appendAttributeLines(a_Chunks[window + a_Index], blocks[a_Index].m_Values, buffer);
+            a_Writer.commit(first_chunk + a_Index, std::move(buffer));
+        });
+    }
+}
+
+void NodeAttributeGenerator::redrawRepeatedValues(const AttributeChunk &a_Chunk, UniqueBlock &a_Block,
+                                                  UniqueValueSet &a_Set) const {
+    if (std::find(a_Block.m_IsRepeated.begin(), a_Block.m_IsRepeated.end(), 1) == a_Block.m_IsRepeated.end()) {
+        return;
+    }
+    const auto &attribute = getAttribute(a_Chunk);
+    // Every node redraws from its own stream, so its new value does not depend on the other repeated values.
+    const RandomStream redraw_stream = getAttributeStream(a_Chunk).split("redraw");
+    const uint64_t first = a_Chunk.m_Block * RandomStream::m_NodesPerStream;
+    // The redrawn values are built in the scratch values of the block, which then trade places with its values.
+    AttributeValues &values = a_Block.m_RedrawnValues;
+    values.clear();
+    for (size_t offset = 0; offset < a_Block.m_Values.getCount(); ++offset) {
+        if (a_Block.m_IsRepeated[offset] == 0) {
+            values.getData().append(a_Block.m_Values.getValue(offset), a_Block.m_Values.getLength(offset));
+            values.endValue();
+            continue;
+        }
+        RandomStream generator = redraw_stream.split(first + offset);
+        const size_t start = values.getData().size();
+        unsigned int nr_draws = 0;
+        do {
+            if (++nr_draws > m_MaxRedraws) {
+                throw std::invalid_argument("Attribute " + attribute->getName() + " of type " +
+                                            *a_Chunk.m_TypeName + " has too few distinct values to be unique for " +
+                                            std::to_string(getNrOfNodes(*a_Chunk.m_TypeName)) + " nodes");
+            }
+            values.getData().resize(start);
+            attribute->appendRandomAttribute(generator, values.getData());
+        } while (!a_Set.insert(UniqueValueSet::getFingerprint(std::string_view(values.getData()).substr(start))));
+        values.endValue();
     }
+    std::swap(a_Block.m_Values, values);
 }
@@ -1,21 +1,92 @@
 #ifndef GMARK_NODE_ATTRIBUTE_GENERATOR_H
 #define GMARK_NODE_ATTRIBUTE_GENERATOR_H
 
+#include "chunk_writer.h"
 #include "configuration.h"
+#include "output_writer.h"
+#include "thread_pool.h"
+#include "unique_value_set.h"
 
 class NodeAttributeGenerator {
 protected:
+    // The values of one attribute for one block of RandomStream::m_NodesPerStream nodes of a type. Every block
+    // draws from its own stream, so the chunks can be generated in any order and on any thread.
+    struct AttributeChunk {
+        const std::string *m_TypeName;
+        size_t m_AttributeIndex;
+        uint64_t m_Block;
+    };
+
+    // A block of a unique attribute. The offsets of the values are grouped by the shard of the UniqueValueSet that
+    // owns their fingerprints, in node order within every shard.
+    struct UniqueBlock {
+        AttributeValues m_Values;
+        std::vector<uint64_t> m_Fingerprints;
+        std::vector<uint32_t> m_ShardOffsets;
+        // The offsets of shard i are m_ShardOffsets[m_ShardStarts[i], m_ShardStarts[i + 1]).
+        std::vector<size_t> m_ShardStarts;
+        // Set for the values that repeat an earlier value. Every shard writes the flags of its own values.
+        std::vector<char> m_IsRepeated;
+        // Scratch space that keeps its memory from one window to the next.
+        std::vector<size_t> m_NextOffsets;
+        AttributeValues m_RedrawnValues;
+    };
+
+    // The number of blocks of a unique attribute that are generated at once. The values of a window are checked
+    // after those of the windows before it, so this must not depend on the number of threads.
+    static const uint64_t m_BlocksPerWindow;
+    // The number of draws for a repeated value before the attribute is deemed to have too few distinct values.
+    static const unsigned int m_MaxRedraws;
+
     const Configuration &m_Config;
+    ThreadPool &m_ThreadPool;
+
+    // The chunks in output order: by type, then by attribute, then by block.
+    std::vector<AttributeChunk> getAttributeChunks(const std::vector<std::string> &a_TypeNames) const;
+
+    const std::unique_ptr<Attribute> &getAttribute(const AttributeChunk &a_Chunk) const {
+        return m_Config.getTypeAttributes(*a_Chunk.m_TypeName)[a_Chunk.m_AttributeIndex];
+    }
+
+    uint64_t getNrOfNodes(const std::string &a_TypeName) const {
+        const auto &type_range = m_Config.getTypeRange(a_TypeName);
+        assert(type_range.first <= type_range.second);
+        return type_range.second - type_range.first + 1;
+    }
 
-    void generateRandomAttributes(const std::string &a_TypeName, std::ostream &a_OutputStream) const;
+    // Whether the attribute of a_Chunk is unique but its values are not distinct by construction.
+    bool needsUniquenessCheck(const AttributeChunk &a_Chunk) const;
 
-    void generateNodeAttributes(const std::unique_ptr<Attribute> &a_Attribute, const int a_StartId,
-                                const int a_EndId, std::ostream &a_OutputStream) const;
+    RandomStream getAttributeStream(const AttributeChunk &a_Chunk) const;
+
+    // Adds the values of the nodes of a_Chunk to a_Values, which is emptied first.
+    void generateAttributeValues(const AttributeChunk &a_Chunk, AttributeValues &a_Values) const;
+
+    void appendAttributeLines(const AttributeChunk &a_Chunk, const AttributeValues &a_Values,
+                              OutputBuffer &a_Buffer) const;
+
+    // Generates and writes the chunks [a_First, a_Last), which need no uniqueness check.
+    void generateChunks(const std::vector<AttributeChunk> &a_Chunks, const size_t a_First, const size_t a_Last,
+                        ChunkWriter &a_Writer);
+
+    // Generates and writes the chunks [a_First, a_Last), which hold all blocks of one unique attribute. The blocks
+    // are generated a window at a time. The values of a window are then checked against a UniqueValueSet by one
+    // task per shard, and repeated values are redrawn in node order from streams of their own nodes.
+    void generateUniqueChunks(const std::vector<AttributeChunk> &a_Chunks, const size_t a_First,
+                              const size_t a_Last, ChunkWriter &a_Writer);
+
+    // Redraws the values of a_Block that are flagged as repeated until they are new to a_Set.
+    void redrawRepeatedValues(const AttributeChunk &a_Chunk, UniqueBlock &a_Block, UniqueValueSet &a_Set) const;
 
 public:
-    explicit NodeAttributeGenerator(const Configuration &a_Config) : m_Config(a_Config) {}
+    NodeAttributeGenerator(const NodeAttributeGenerator &) = delete; // no copy operations.
+    NodeAttributeGenerator &operator=(const NodeAttributeGenerator &) = delete; // no copy operations.
+
+    NodeAttributeGenerator(const Configuration &a_Config, ThreadPool &a_ThreadPool)
+            : m_Config(a_Config),
+              m_ThreadPool(a_ThreadPool) {}
 
-    void generateAttributes(std::ostream &a_OutputStream);
+    void generateAttributes(OutputWriter &a_Writer);
 };
 
 #endif //GMARK_NODE_ATTRIBUTE_GENERATOR_H
@@ -0,0 +1,73 @@
+#include "output_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+const size_t OutputBuffer::m_WriterCapacity = 1U << 22U;
+const size_t OutputBuffer::m_DetachedCapacity = 1U << 16U;
+
+OutputWriter::OutputWriter(const std::string &a_FileName)
+        : m_FileDescriptor(STDOUT_FILENO),
+          m_OwnsFileDescriptor(false),
+          m_StartTime(std::chrono::steady_clock::now()) {
+    if (!a_FileName.empty()) {
+        m_FileDescriptor = open(a_FileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (m_FileDescriptor == -1) {
+            throw std::invalid_argument("Cannot open output file " + a_FileName + ": " + std::strerror(errno));
+        }
+        m_OwnsFileDescriptor = true;
+    }
+}
+
+OutputWriter::~OutputWriter() {
+    if (m_OwnsFileDescriptor) {
+        close(m_FileDescriptor);
+    }
+}
+
+void OutputWriter::write(const char *a_Data, const size_t a_Length) {
+    size_t written = 0;
+    while (written < a_Length) {
+        const ssize_t result = ::write(m_FileDescriptor, a_Data + written, a_Length - written);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Cannot write output: ") + std::strerror(errno));
+        }
+        written += static_cast<size_t>(result);
+    }
+    m_BytesWritten += a_Length;
+}
+
+double OutputWriter::getElapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+}
+
+double OutputWriter::getThroughput() const {
+    const double seconds = getElapsedSeconds();
+    if (seconds <= 0.0) {
+        return 0.0;
+    }
+    return static_cast<double>(m_BytesWritten) / 1e6 / seconds;
+}
+
+OutputBuffer::OutputBuffer(OutputWriter *a_Writer)
+        : m_Data(a_Writer == nullptr ? m_DetachedCapacity : m_WriterCapacity),
+          m_Writer(a_Writer) {}
+
+void OutputBuffer::makeRoom(const size_t a_Length) {
+    flush();
+    if (m_Size + a_Length > m_Data.size()) {
+        m_Data.resize(std::max(m_Data.size() * 2, m_Size + a_Length));
+    }
+}
+
+void OutputBuffer::flush() {
+    if (m_Writer != nullptr && m_Size > 0) {
+        m_Writer->write(m_Data.data(), m_Size);
+        m_Size = 0;
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef GMARK_OUTPUT_WRITER_H
+#define GMARK_OUTPUT_WRITER_H
+
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+enum class E_OUTPUT_FORMAT {
+    TEXT,
+    BINARY,
+    CSR
+};
+
+// Writes raw bytes to a file descriptor with plain write(2) calls and keeps track of the throughput. Callers are
+// expected to hand over large blocks, see OutputBuffer.
+class OutputWriter {
+private:
+    int m_FileDescriptor;
+    bool m_OwnsFileDescriptor;
+    uint64_t m_BytesWritten = 0;
+    const std::chrono::steady_clock::time_point m_StartTime;
+
+public:
+    OutputWriter(const OutputWriter &) = delete; // no copy operations.
+    OutputWriter &operator=(const OutputWriter &) = delete; // no copy operations.
+
+    // Writes to standard output when a_FileName is empty.
+    explicit OutputWriter(const std::string &a_FileName);
+
+    ~OutputWriter();
+
+    void write(const char *a_Data, const size_t a_Length);
+
+    void write(const std::string &a_String) {
+        write(a_String.data(), a_String.size());
+    }
+
+    uint64_t getBytesWritten() const {
+        return m_BytesWritten;
+    }
+
+    double getElapsedSeconds() const;
+
+    // In megabytes (10^6 bytes) per second since the writer was created.
+    double getThroughput() const;
+};
+
+// A reusable byte buffer that rows are formatted into. A buffer that is attached to a writer hands its contents to
+// the writer whenever it is full, so its memory stays constant. A detached buffer grows instead, which is used to
+// produce chunks of output concurrently that are written later.
+class OutputBuffer {
+private:
+    std::vector<char> m_Data;
+    size_t m_Size = 0;
+    OutputWriter *m_Writer;
+
+    void makeRoom(const size_t a_Length);
+
+public:
+    static const size_t m_WriterCapacity;
+    static const size_t m_DetachedCapacity;
+
+    explicit OutputBuffer(OutputWriter *a_Writer = nullptr);
+
+    void append(const char *a_Data, const size_t a_Length) {
+        if (m_Size + a_Length > m_Data.size()) {
+            makeRoom(a_Length);
+        }
+        std::memcpy(m_Data.data() + m_Size, a_Data, a_Length);
+        m_Size += a_Length;
+    }
+
+    void append(const std::string &a_String) {
+        append(a_String.data(), a_String.size());
+    }
+
+    void append(const char a_Character) {
+        if (m_Size == m_Data.size()) {
+            makeRoom(1);
+        }
+        m_Data[m_Size++] = a_Character;
+    }
+
+    template<typename Integer>
+    void appendInteger(const Integer a_Value) {
+        constexpr size_t max_length = std::numeric_limits<Integer>::digits10 + 2;
+        if (m_Size + max_length > m_Data.size()) {
+            makeRoom(max_length);
+        }
+        char *const begin = m_Data.data() + m_Size;
+        const auto result = std::to_chars(begin, begin + max_length, a_Value);
+        m_Size += static_cast<size_t>(result.ptr - begin);
+    }
+
+    // Writes the value as sizeof(Integer) bytes, least significant byte first, regardless of the host byte order.
+    template<typename Integer>
+    void appendLittleEndian(const Integer a_Value) {
+        if (m_Size + sizeof(Integer) > m_Data.size()) {
+            makeRoom(sizeof(Integer));
+        }
+        auto value = static_cast<typename std::make_unsigned<Integer>::type>(a_Value);
+        for (size_t i = 0; i < sizeof(Integer); ++i) {
+            m_Data[m_Size++] = static_cast<char>(value & 0xFFU);
+            value = static_cast<decltype(value)>(value >> 8U);
+        }
+    }
+
+    const char *getData() const {
+        return m_Data.data();
+    }
+
+    size_t getSize() const {
+        return m_Size;
+    }
+
+    // Hands the buffered bytes to the attached writer, if any.
+    void flush();
+
+    // Drops the buffered bytes but keeps the memory.
+    void clear() {
+        m_Size = 0;
+    }
+};
+
+#endif //GMARK_OUTPUT_WRITER_H
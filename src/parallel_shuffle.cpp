@@ -0,0 +1,74 @@
+#include "parallel_shuffle.h"
+#include <algorithm>
+#include <cstdint>
+
+template<typename Value>
+void parallelShuffle(std::vector<Value> &a_Values, const RandomStream &a_Stream, ThreadPool &a_ThreadPool) {
+    // Buckets of about this many values are shuffled sequentially, which keeps them in the cache.
+    constexpr size_t values_per_bucket = 1U << 16U;
+    constexpr size_t max_nr_buckets = 1U << 10U;
+    // The values are scattered in chunks of this size, each with its own stream.
+    constexpr size_t values_per_chunk = 1U << 20U;
+    const size_t nr_values = a_Values.size();
+    const size_t nr_buckets = std::min(max_nr_buckets, nr_values / values_per_bucket);
+    if (nr_buckets <= 1) {
+        RandomStream generator = a_Stream.split("bucket").split(0);
+        std::shuffle(a_Values.begin(), a_Values.end(), generator);
+        return;
+    }
+    const size_t nr_chunks = (nr_values + values_per_chunk - 1) / values_per_chunk;
+    const RandomStream scatter_stream = a_Stream.split("scatter");
+
+    // Every chunk draws the bucket of each of its values and stores it, so that the scatter pass does not have to
+    // draw them again. The buckets fit in 16 bits.
+    std::vector<uint16_t> buckets(nr_values);
+    std::vector<std::vector<size_t>> positions(nr_chunks, std::vector<size_t>(nr_buckets, 0));
+    a_ThreadPool.parallelFor(nr_chunks, [&scatter_stream, &buckets, &positions, nr_values, nr_buckets](
+            const size_t a_Chunk) {
+        RandomStream generator = scatter_stream.split(a_Chunk);
+        const size_t first = a_Chunk * values_per_chunk;
+        const size_t last = std::min(first + values_per_chunk, nr_values);
+        for (size_t i = first; i < last; ++i) {
+            const uint32_t bucket = generator.getBoundedInteger(static_cast<uint32_t>(nr_buckets));
+            buckets[i] = static_cast<uint16_t>(bucket);
+            ++positions[a_Chunk][bucket];
+        }
+    });
+    std::vector<size_t> bucket_offsets(nr_buckets + 1, 0);
+    size_t position = 0;
+    for (size_t bucket = 0; bucket < nr_buckets; ++bucket) {
+        bucket_offsets[bucket] = position;
+        for (size_t chunk = 0; chunk < nr_chunks; ++chunk) {
+            const size_t count = positions[chunk][bucket];
+            positions[chunk][bucket] = position;
+            position += count;
+        }
+    }
+    bucket_offsets[nr_buckets] = position;
+
+    std::vector<Value> scattered(nr_values);
+    a_ThreadPool.parallelFor(nr_chunks, [&a_Values, &buckets, &positions, &scattered, nr_values](
+            const size_t a_Chunk) {
+        auto &chunk_positions = positions[a_Chunk];
+        const size_t first = a_Chunk * values_per_chunk;
+        const size_t last = std::min(first + values_per_chunk, nr_values);
+        for (size_t i = first; i < last; ++i) {
+            scattered[chunk_positions[buckets[i]]++] = a_Values[i];
+        }
+    });
+    std::vector<uint16_t>().swap(buckets);
+
+    const RandomStream bucket_stream = a_Stream.split("bucket");
+    a_ThreadPool.parallelFor(nr_buckets, [&bucket_stream, &bucket_offsets, &scattered](const size_t a_Bucket) {
+        RandomStream generator = bucket_stream.split(a_Bucket);
+        std::shuffle(scattered.begin() + static_cast<std::ptrdiff_t>(bucket_offsets[a_Bucket]),
+                     scattered.begin() + static_cast<std::ptrdiff_t>(bucket_offsets[a_Bucket + 1]), generator);
+    });
+    a_Values.swap(scattered);
+}
+
+template void parallelShuffle(std::vector<uint32_t> &a_Values, const RandomStream &a_Stream,
+                              ThreadPool &a_ThreadPool);
+
+template void parallelShuffle(std::vector<uint64_t> &a_Values, const RandomStream &a_Stream,
+                              ThreadPool &a_ThreadPool);
@@ -0,0 +1,16 @@
+#ifndef GMARK_PARALLEL_SHUFFLE_H
+#define GMARK_PARALLEL_SHUFFLE_H
+
+#include <vector>
+#include "random_stream.h"
+#include "thread_pool.h"
+
+// Shuffles a_Values uniformly at random with all threads of the pool. Every value is first scattered into one of
+// several buckets that is chosen uniformly at random, after which every bucket is shuffled on its own and the
+// buckets are concatenated (Rao-Sandelius). Both the scatter, which draws per fixed-size chunk of values, and the
+// buckets use their own streams split from a_Stream. The number of buckets only depends on the number of values, so
+// the result is the same for any number of threads. The scatter needs a second array of the same size.
+template<typename Value>
+void parallelShuffle(std::vector<Value> &a_Values, const RandomStream &a_Stream, ThreadPool &a_ThreadPool);
+
+#endif //GMARK_PARALLEL_SHUFFLE_H
@@ -1,45 +1,125 @@
 #ifndef GMARK_RANDOM_DISTRIBUTION_H
 #define GMARK_RANDOM_DISTRIBUTION_H
 
+#include <algorithm>
+#include <array>
 #include <random>
+#include <stdexcept>
 #include <cassert>
+#include "random_stream.h"
+#include "sampling_kernels.h"
+#include "random_permutation.h"
 
 class RandomDistribution {
     // TODO (thom): enforce min, max, unique.
 protected:
-    std::mt19937 m_Generator{std::random_device{}()};
     const std::string m_Name;
 
     explicit RandomDistribution(const std::string &a_Name) : m_Name(a_Name) {
         assert(!m_Name.empty());
     }
 
+    // Integer draws outside the range of an int are saturated to its nearest bound instead of wrapping.
+    static int saturateToInt(const int64_t a_Value) {
+        return static_cast<int>(std::clamp<int64_t>(a_Value, std::numeric_limits<int>::min(),
+                                                    std::numeric_limits<int>::max()));
+    }
+
 public:
     const std::string getName() const {
         return m_Name;
     }
 
-    virtual int getRandomInteger() = 0;
+    // Draws use the caller's stream, so that one distribution can serve several independent streams. The std::
+    // distributions are copied before use because some of them cache values between calls, which would leak
+    // state from one stream into the next.
+    virtual int getRandomInteger(RandomStream &a_Generator) = 0;
+
+    virtual double getRandomDouble(RandomStream &a_Generator) = 0;
 
-    virtual double getRandomDouble() = 0;
+    // Fill a_Values with a_Count draws, which are the same as a_Count consecutive single draws. The virtual call is
+    // made once per batch instead of once per value.
+    virtual void getRandomIntegers(RandomStream &a_Generator, int *a_Values, const size_t a_Count) = 0;
 
+    virtual void getRandomDoubles(RandomStream &a_Generator, double *a_Values, const size_t a_Count) = 0;
+
+    // Infinite when the mean does not exist.
     virtual double getMean() const = 0;
 
+    // Infinite when the variance does not exist.
+    virtual double getVariance() const = 0;
+
+    // Unique distributions draw without replacement. Their a_Index-th value only depends on a_Index and a_Stream,
+    // so any range of values can be produced independently.
+    virtual bool isUnique() const {
+        return false;
+    }
+
+    virtual void getUniqueDoubles(const RandomStream &a_Stream, const uint64_t a_FirstIndex, double *const a_Values,
+                                  const size_t a_Count) const {
+        throw std::logic_error("Distribution " + m_Name + " cannot produce unique values");
+    }
+
+    // Whether the first a_NrOfValues values of getUniqueDoubles are distinct doubles in [a_Min, a_Max], so that they
+    // stay distinct when they are clamped to those bounds and formatted.
+    virtual bool hasDistinctDoubles(const uint64_t a_NrOfValues, const double a_Min, const double a_Max) const {
+        return false;
+    }
+
     virtual ~RandomDistribution() = 0;
 };
 
-class UniformIntegerDistribution : public RandomDistribution {
+// Implements the batch draws of a distribution as loops over its single draws. Distribution must be final, so that
+// the calls in the loops are resolved statically and can be inlined. Distributions with vectorised samplers
+// override the batch draws instead.
+template<typename Distribution>
+class BatchDistribution : public RandomDistribution {
+protected:
+    explicit BatchDistribution(const std::string &a_Name) : RandomDistribution(a_Name) {}
+
+    // Fills a_Values with the rounded values of batches of doubles that a_Sample draws, in tiles on the stack.
+    template<typename Sampler>
+    static void roundBatch(int *const a_Values, const size_t a_Count, const Sampler &a_Sample) {
+        constexpr size_t tile_size = 256;
+        std::array<double, tile_size> doubles{};
+        for (size_t first = 0; first < a_Count; first += tile_size) {
+            const size_t count = std::min(tile_size, a_Count - first);
+            a_Sample(doubles.data(), count);
+            for (size_t i = 0; i < count; ++i) {
+                a_Values[first + i] = static_cast<int>(std::round(doubles[i]));
+            }
+        }
+    }
+
+public:
+    void getRandomIntegers(RandomStream &a_Generator, int *const a_Values, const size_t a_Count) override {
+        auto &distribution = static_cast<Distribution &>(*this);
+        for (size_t i = 0; i < a_Count; ++i) {
+            a_Values[i] = distribution.getRandomInteger(a_Generator);
+        }
+    }
+
+    void getRandomDoubles(RandomStream &a_Generator, double *const a_Values, const size_t a_Count) override {
+        auto &distribution = static_cast<Distribution &>(*this);
+        for (size_t i = 0; i < a_Count; ++i) {
+            a_Values[i] = distribution.getRandomDouble(a_Generator);
+        }
+    }
+};
+
+class UniformIntegerDistribution final : public BatchDistribution<UniformIntegerDistribution> {
 private:
-    const int m_Min;
-    const int m_Max;
+    const int64_t m_Min;
+    const int64_t m_Max;
     const double m_Mean;
-    std::uniform_int_distribution<int> m_Distribution;
+    std::uniform_int_distribution<int64_t> m_Distribution;
 public:
-    UniformIntegerDistribution(int a_Min, int a_Max) :
-            RandomDistribution("uniform"),
+    // The bounds are 64-bit, as dates are seconds since the epoch. Integer draws are saturated to the int range.
+    UniformIntegerDistribution(int64_t a_Min, int64_t a_Max) :
+            BatchDistribution("uniform"),
             m_Min(a_Min),
             m_Max(a_Max),
-            m_Mean(static_cast<double>(m_Min + m_Max) / 2.0),
+            m_Mean((static_cast<double>(m_Min) + static_cast<double>(m_Max)) / 2.0),
             m_Distribution(m_Min, m_Max) {
         assert(m_Min <= m_Max);
     }
@@ -48,41 +128,101 @@ public:
         return m_Mean;
     }
 
-    int getRandomInteger() override {
-        return m_Distribution(m_Generator);
+    double getVariance() const override {
+        const double width = static_cast<double>(m_Max) - static_cast<double>(m_Min) + 1.0;
+        return (width * width - 1.0) / 12.0;
+    }
+
+    int getRandomInteger(RandomStream &a_Generator) override {
+        auto distribution = m_Distribution;
+        return saturateToInt(distribution(a_Generator));
     }
 
-    double getRandomDouble() override {
-        return static_cast<double>(getRandomInteger());
+    double getRandomDouble(RandomStream &a_Generator) override {
+        auto distribution = m_Distribution;
+        return static_cast<double>(distribution(a_Generator));
     }
 };
 
-class UniformIntegerUniqueDistribution : public RandomDistribution {
+// Unique integers in [min, max]. The i-th value is min + i when the range is unbounded, which is a counter, and
+// min plus the i-th value of a keyed permutation of the range otherwise. The permutation is a Feistel network with
+// cycle-walking, so it needs O(1) memory. Single draws have no index and are merely uniform, not unique; their
+// integer draws are saturated to the int range.
+class UniformIntegerUniqueDistribution final : public BatchDistribution<UniformIntegerUniqueDistribution> {
 private:
-    int m_Counter;
-    const int m_Min;
+    const int64_t m_Min;
+    const int64_t m_Max;
+    const bool m_Permuted;
     const double m_Mean;
+    std::uniform_int_distribution<int64_t> m_Distribution;
 public:
-    explicit UniformIntegerUniqueDistribution(int a_Min) :
-            RandomDistribution("counter"),
-            m_Counter(a_Min - 1),
+    // Without a_Permuted the values are a counter starting at a_Min.
+    UniformIntegerUniqueDistribution(int64_t a_Min, int64_t a_Max, bool a_Permuted) :
+            BatchDistribution("unique"),
             m_Min(a_Min),
-            m_Mean(static_cast<double>(std::numeric_limits<int>::max() -  m_Min) / 2.0) {}
+            m_Max(a_Max),
+            m_Permuted(a_Permuted),
+            m_Mean((static_cast<double>(a_Min) + static_cast<double>(a_Max)) / 2.0),
+            m_Distribution(a_Min, a_Max) {
+        assert(m_Min <= m_Max);
+    }
 
     double getMean() const override {
         return m_Mean;
     }
 
-    int getRandomInteger() override {
-        return ++m_Counter;
+    double getVariance() const override {
+        const double width = static_cast<double>(m_Max) - static_cast<double>(m_Min) + 1.0;
+        return (width * width - 1.0) / 12.0;
+    }
+
+    int getRandomInteger(RandomStream &a_Generator) override {
+        auto distribution = m_Distribution;
+        return saturateToInt(distribution(a_Generator));
+    }
+
+    double getRandomDouble(RandomStream &a_Generator) override {
+        auto distribution = m_Distribution;
+        return static_cast<double>(distribution(a_Generator));
+    }
+
+    bool isUnique() const override {
+        return true;
     }
 
-    double getRandomDouble() override {
-        return static_cast<double>(getRandomInteger());
+    bool hasDistinctDoubles(const uint64_t a_NrOfValues, const double a_Min, const double a_Max) const override {
+        // Doubles hold every integer up to 2^53 exactly.
+        constexpr int64_t exact_limit = static_cast<int64_t>(1) << 53;
+        if (a_NrOfValues == 0) {
+            return true;
+        }
+        // A permuted range may produce any of its values, a counter only the first ones.
+        const uint64_t last_offset = static_cast<uint64_t>(m_Max) - static_cast<uint64_t>(m_Min);
+        const int64_t last = m_Permuted || a_NrOfValues - 1 >= last_offset
+                             ? m_Max : static_cast<int64_t>(static_cast<uint64_t>(m_Min) + (a_NrOfValues - 1));
+        return m_Min >= -exact_limit && last <= exact_limit && static_cast<double>(m_Min) >= a_Min &&
+               static_cast<double>(last) <= a_Max;
+    }
+
+    void getUniqueDoubles(const RandomStream &a_Stream, const uint64_t a_FirstIndex, double *const a_Values,
+                          const size_t a_Count) const override {
+        // The range may hold 2^64 values, which is one more than a uint64_t can count.
+        const uint64_t last_offset = static_cast<uint64_t>(m_Max) - static_cast<uint64_t>(m_Min);
+        if (a_Count > 0 && a_FirstIndex + (a_Count - 1) > last_offset) {
+            throw std::invalid_argument("There are more nodes than unique values in [" + std::to_string(m_Min) +
+                                        ", " + std::to_string(m_Max) + "]");
+        }
+        assert(!m_Permuted || last_offset < std::numeric_limits<uint64_t>::max());
+        const FeistelPermutation permutation = m_Permuted ? FeistelPermutation(last_offset + 1, a_Stream)
+                                                          : FeistelPermutation();
+        for (size_t i = 0; i < a_Count; ++i) {
+            const uint64_t offset = m_Permuted ? permutation(a_FirstIndex + i) : a_FirstIndex + i;
+            a_Values[i] = static_cast<double>(static_cast<int64_t>(static_cast<uint64_t>(m_Min) + offset));
+        }
     }
 };
 
-class UniformDoubleDistribution : public RandomDistribution {
+class UniformDoubleDistribution final : public BatchDistribution<UniformDoubleDistribution> {
 private:
     const double m_Min;
     const double m_Max;
@@ -90,7 +230,7 @@ private:
     std::uniform_real_distribution<double> m_Distribution;
 public:
     UniformDoubleDistribution(double a_Min, double a_Max) :
-            RandomDistribution("uniform"),
+            BatchDistribution("uniform"),
             m_Min(a_Min),
             m_Max(a_Max),
             m_Mean((m_Min + m_Max) / 2.0),
@@ -102,26 +242,29 @@ public:
         return m_Mean;
     }
 
-    int getRandomInteger() override {
-        return static_cast<int>(getRandomDouble());
+    double getVariance() const override {
+        return (m_Max - m_Min) * (m_Max - m_Min) / 12.0;
+    }
+
+    int getRandomInteger(RandomStream &a_Generator) override {
+        return static_cast<int>(getRandomDouble(a_Generator));
     }
 
-    double getRandomDouble() override {
-        return m_Distribution(m_Generator);
+    double getRandomDouble(RandomStream &a_Generator) override {
+        auto distribution = m_Distribution;
+        return distribution(a_Generator);
     }
 };
 
-class GaussianDistribution : public RandomDistribution {
+class GaussianDistribution final : public BatchDistribution<GaussianDistribution> {
 private:
     const double m_Mean;
     const double m_StandardDeviation;
-    std::normal_distribution<double> m_Distribution;
 public:
     GaussianDistribution(double a_Mean, double a_StandardDeviation)
-            : RandomDistribution("gaussian"),
+            : BatchDistribution("gaussian"),
               m_Mean(a_Mean),
-              m_StandardDeviation(a_StandardDeviation),
-              m_Distribution(a_Mean, a_StandardDeviation) {
+              m_StandardDeviation(a_StandardDeviation) {
         assert(!std::isnan(m_Mean));
         assert(!std::isnan(m_StandardDeviation));
         assert(m_StandardDeviation > 0.0);
@@ -131,44 +274,141 @@ public:
         return m_Mean;
     }
 
-    int getRandomInteger() override {
-        return static_cast<int>(std::round(getRandomDouble()));
+    double getVariance() const override {
+        return m_StandardDeviation * m_StandardDeviation;
+    }
+
+    int getRandomInteger(RandomStream &a_Generator) override {
+        return static_cast<int>(std::round(getRandomDouble(a_Generator)));
+    }
+
+    double getRandomDouble(RandomStream &a_Generator) override {
+        return sampleGaussian(a_Generator, m_Mean, m_StandardDeviation);
+    }
+
+    void getRandomIntegers(RandomStream &a_Generator, int *const a_Values, const size_t a_Count) override {
+        roundBatch(a_Values, a_Count, [this, &a_Generator](double *const a_Doubles, const size_t a_DoubleCount) {
+            getRandomDoubles(a_Generator, a_Doubles, a_DoubleCount);
+        });
     }
 
-    double getRandomDouble() override {
-        return m_Distribution(m_Generator);
+    void getRandomDoubles(RandomStream &a_Generator, double *const a_Values, const size_t a_Count) override {
+        sampleGaussians(a_Generator, m_Mean, m_StandardDeviation, a_Values, a_Count);
     }
 };
 
-class ZipfianDistribution : public RandomDistribution {
+// Ranks up to m_MaxTableSize are drawn exactly by a binary search in the cumulative distribution. Larger ranges
+// use rejection-inversion (Hörmann and Derflinger, "Rejection-inversion to generate variates from monotone discrete
+// distributions"), which needs O(1) time per draw and no table: a continuous envelope is sampled by inverting its
+// integral H, and a draw is accepted with a test that rarely fails.
+class ZipfianDistribution final : public BatchDistribution<ZipfianDistribution> {
 private:
+    static constexpr uint64_t m_MaxTableSize = 1U << 16U;
+
+    const double m_Exponent;
+    const uint64_t m_Number;
     const double m_NthHarmonicNumber;
     const double m_NumericMean;
+    const double m_NumericVariance;
     std::vector<double> m_CDF;
+    double m_HIntegralX1 = 0.0;
+    double m_HIntegralNumber = 0.0;
+    double m_S = 0.0;
     std::uniform_real_distribution<double> m_Distribution;
 
-    static double generalizedHarmonic(const int a_N, const double a_M) {
+    // The first m_ExactHarmonicTerms terms of a harmonic number are summed and the rest is approximated by
+    // Euler-Maclaurin summation, whose error is below double precision from this point on.
+    static constexpr uint64_t m_ExactHarmonicTerms = 64;
+
+    // The sum of n^-a_M for n in [1, a_N] in constant time.
+    static double generalizedHarmonic(const uint64_t a_N, const double a_M) {
         double nth_harmonic = 0.0;
-        for (int n = a_N; n > 0; --n) {
+        for (uint64_t n = std::min(a_N, m_ExactHarmonicTerms); n > 0; --n) {
             nth_harmonic += 1.0 / std::pow(static_cast<double>(n), a_M);
         }
+        if (a_N <= m_ExactHarmonicTerms) {
+            return nth_harmonic;
+        }
+        // The terms in (k, n] are the integral of x^-m over [k, n] plus the endpoint and derivative corrections.
+        constexpr std::array<double, 4> bernoulli{1.0 / 6.0, -1.0 / 30.0, 1.0 / 42.0, -1.0 / 30.0};
+        const auto k = static_cast<double>(m_ExactHarmonicTerms);
+        const auto n = static_cast<double>(a_N);
+        const double log_ratio = std::log(n / k);
+        // (n^(1 - m) - k^(1 - m)) / (1 - m), which is k^(1 - m) log(n / k) for m = 1.
+        nth_harmonic += std::pow(k, 1.0 - a_M) * log_ratio * expRatio((1.0 - a_M) * log_ratio);
+        nth_harmonic += (std::pow(n, -a_M) - std::pow(k, -a_M)) / 2.0;
+        double factor = a_M;
+        double factorial = 2.0;
+        for (size_t i = 0; i < bernoulli.size(); ++i) {
+            const auto j = static_cast<double>(2 * i);
+            nth_harmonic += bernoulli[i] / factorial * factor *
+                            (std::pow(k, -a_M - j - 1.0) - std::pow(n, -a_M - j - 1.0));
+            factor *= (a_M + j + 1.0) * (a_M + j + 2.0);
+            factorial *= (j + 3.0) * (j + 4.0);
+        }
         return nth_harmonic;
     }
 
+    // log(1 + x) / x, which is accurate around 0.
+    static double logRatio(const double a_X) {
+        if (std::abs(a_X) > 1e-8) {
+            return std::log1p(a_X) / a_X;
+        }
+        return 1.0 - a_X * (0.5 - a_X * (1.0 / 3.0 - 0.25 * a_X));
+    }
+
+    // (exp(x) - 1) / x, which is accurate around 0.
+    static double expRatio(const double a_X) {
+        if (std::abs(a_X) > 1e-8) {
+            return std::expm1(a_X) / a_X;
+        }
+        return 1.0 + a_X * 0.5 * (1.0 + a_X / 3.0 * (1.0 + 0.25 * a_X));
+    }
+
+    // The envelope h(x) = x^-s.
+    double h(const double a_X) const {
+        return std::exp(-m_Exponent * std::log(a_X));
+    }
+
+    // H(x) = (x^(1 - s) - 1) / (1 - s), the integral of h, which is log(x) for s = 1.
+    double hIntegral(const double a_X) const {
+        const double log_x = std::log(a_X);
+        return expRatio((1.0 - m_Exponent) * log_x) * log_x;
+    }
+
+    double hIntegralInverse(const double a_X) const {
+        double t = a_X * (1.0 - m_Exponent);
+        if (t < -1.0) {
+            // Limits the value to the domain of the logarithm in case of rounding errors.
+            t = -1.0;
+        }
+        return std::exp(logRatio(t) * a_X);
+    }
+
 public:
-    ZipfianDistribution(double a_Exponent, int a_Number)
-            : RandomDistribution("zipfian"),
+    ZipfianDistribution(double a_Exponent, uint64_t a_Number)
+            : BatchDistribution("zipfian"),
+              m_Exponent(a_Exponent),
+              m_Number(a_Number),
               m_NthHarmonicNumber(generalizedHarmonic(a_Number, a_Exponent)),
               m_NumericMean(generalizedHarmonic(a_Number, a_Exponent - 1.0) / m_NthHarmonicNumber),
+              m_NumericVariance(generalizedHarmonic(a_Number, a_Exponent - 2.0) / m_NthHarmonicNumber -
+                                m_NumericMean * m_NumericMean),
               m_Distribution(0.0, 1.0) {
         assert(a_Number > 0);
         assert(!std::isnan(a_Exponent));
         assert(a_Exponent >= 0.0);
-        m_CDF.reserve(static_cast<size_t>(a_Number));
-        double rank_harmonic = 0.0;
-        for (int n = 1; n <= a_Number; n++) {
-            rank_harmonic += 1.0 / std::pow(static_cast<double>(n), a_Exponent);
-            m_CDF.push_back(rank_harmonic / m_NthHarmonicNumber);
+        if (a_Number <= m_MaxTableSize) {
+            m_CDF.reserve(static_cast<size_t>(a_Number));
+            double rank_harmonic = 0.0;
+            for (uint64_t n = 1; n <= a_Number; n++) {
+                rank_harmonic += 1.0 / std::pow(static_cast<double>(n), a_Exponent);
+                m_CDF.push_back(rank_harmonic / m_NthHarmonicNumber);
+            }
+        } else {
+            m_HIntegralX1 = hIntegral(1.5) - 1.0;
+            m_HIntegralNumber = hIntegral(static_cast<double>(a_Number) + 0.5);
+            m_S = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
         }
     }
 
@@ -176,59 +416,131 @@ public:
         return m_NumericMean;
     }
 
-    int getRandomInteger() override {
-        double z = m_Distribution(m_Generator);
-        auto p = std::lower_bound(m_CDF.begin(), m_CDF.end(), z);
-        return static_cast<int>(std::distance(m_CDF.begin(), p)) + 1;
+    double getVariance() const override {
+        return m_NumericVariance;
+    }
+
+    int getRandomInteger(RandomStream &a_Generator) override {
+        auto distribution = m_Distribution;
+        if (!m_CDF.empty()) {
+            double z = distribution(a_Generator);
+            auto p = std::lower_bound(m_CDF.begin(), m_CDF.end(), z);
+            return static_cast<int>(std::distance(m_CDF.begin(), p)) + 1;
+        }
+        const auto max_rank = static_cast<double>(m_Number);
+        while (true) {
+            // u is uniform in (H(1.5) - 1, H(n + 0.5)].
+            const double u = m_HIntegralNumber + distribution(a_Generator) * (m_HIntegralX1 - m_HIntegralNumber);
+            const double x = hIntegralInverse(u);
+            const double k = std::min(std::max(std::floor(x + 0.5), 1.0), max_rank);
+            // The first test accepts most draws without evaluating H.
+            if (k - x <= m_S || u >= hIntegral(k + 0.5) - h(k)) {
+                // Degrees are ints, so ranks beyond the largest int, which exist for more than 2^31 nodes, are
+                // saturated to it.
+                return static_cast<int>(std::min(k, static_cast<double>(std::numeric_limits<int>::max())));
+            }
+        }
     }
 
-    double getRandomDouble() override {
-        return static_cast<double>(getRandomInteger());
+    double getRandomDouble(RandomStream &a_Generator) override {
+        return static_cast<double>(getRandomInteger(a_Generator));
     }
 };
 
-class ZetaDistribution : public RandomDistribution {
+// Draws are made with Devroye's rejection method ("Non-Uniform Random Variate Generation", X.6), which needs no
+// table and at most about 1.3 tries on average for any alpha, including heavy tails close to 1. Values that do not
+// fit in an int are saturated to the largest int.
+class ZetaDistribution final : public BatchDistribution<ZetaDistribution> {
 private:
     const double m_Alpha;
+    const double m_B;
+    const double m_Mean;
+    const double m_Variance;
+    std::uniform_real_distribution<double> m_Distribution;
+
+    // The Riemann zeta function for s > 1 by Euler-Maclaurin summation, which is accurate to double precision.
+    static double riemannZeta(const double a_S) {
+        constexpr unsigned int nr_terms = 10;
+        constexpr std::array<double, 6> bernoulli{1.0 / 6.0, -1.0 / 30.0, 1.0 / 42.0, -1.0 / 30.0, 5.0 / 66.0,
+                                                  -691.0 / 2730.0};
+        double sum = 0.0;
+        for (unsigned int n = 1; n < nr_terms; ++n) {
+            sum += std::pow(static_cast<double>(n), -a_S);
+        }
+        const auto n = static_cast<double>(nr_terms);
+        sum += std::pow(n, 1.0 - a_S) / (a_S - 1.0) + std::pow(n, -a_S) / 2.0;
+        double factor = a_S * std::pow(n, -a_S - 1.0);
+        double factorial = 2.0;
+        for (size_t k = 0; k < bernoulli.size(); ++k) {
+            sum += bernoulli[k] / factorial * factor;
+            const auto j = static_cast<double>(2 * k);
+            factor *= (a_S + j + 1.0) * (a_S + j + 2.0) / (n * n);
+            factorial *= (j + 3.0) * (j + 4.0);
+        }
+        return sum;
+    }
+
 public:
     explicit ZetaDistribution(double a_Alpha)
-            : RandomDistribution("zeta"),
-              m_Alpha(a_Alpha) {
+            : BatchDistribution("zeta"),
+              m_Alpha(a_Alpha),
+              m_B(std::pow(2.0, a_Alpha - 1.0)),
+              // The mean does not exist for alpha <= 2. The saturated draws have a finite mean, but it is dominated
+              // by the values piled onto the largest int, so it is reported as infinite as well.
+              m_Mean(a_Alpha > 2.0 ? riemannZeta(a_Alpha - 1.0) / riemannZeta(a_Alpha)
+                                   : std::numeric_limits<double>::infinity()),
+              m_Variance(a_Alpha > 3.0 ? riemannZeta(a_Alpha - 2.0) / riemannZeta(a_Alpha) - m_Mean * m_Mean
+                                       : std::numeric_limits<double>::infinity()),
+              m_Distribution(0.0, 1.0) {
         assert(!std::isnan(m_Alpha));
         assert(m_Alpha > 1.0);
     }
 
     double getMean() const override {
-        //TODO: Riemann-Zeta mean.
-        //Riemann-Zeta function evaluated at (s - 1)
-        // Divided by the Riemann-Zeta function evaluated at (s)
-        // For s > 2
-        // For other s, maybe just return the mode = 1
-        return 0.0;
+        return m_Mean;
     }
 
-    int getRandomInteger() override {
-        // TODO: implement this. (Zeta distribution)
-        return 0;
+    double getVariance() const override {
+        return m_Variance;
+    }
+
+    // Values above the largest int are returned as the largest int, so the tail beyond it is piled onto that
+    // value instead of being redrawn. For alpha near 1 that tail holds most of the mass, and redrawing it would both
+    // cut the distribution off and make the sampler reject most candidates. The acceptance ratio of such values
+    // differs from 1 by about alpha / x, so they are accepted without the test.
+    int getRandomInteger(RandomStream &a_Generator) override {
+        auto distribution = m_Distribution;
+        const auto max_value = static_cast<double>(std::numeric_limits<int>::max());
+        while (true) {
+            // 1 - u is in (0, 1], so the power is finite or infinite but never undefined.
+            const double u = 1.0 - distribution(a_Generator);
+            const double v = distribution(a_Generator);
+            const double x = std::floor(std::pow(u, -1.0 / (m_Alpha - 1.0)));
+            if (x > max_value) {
+                // v is still drawn, so every candidate takes two values of the stream.
+                return std::numeric_limits<int>::max();
+            }
+            const double t = std::pow(1.0 + 1.0 / x, m_Alpha - 1.0);
+            if (v * x * (t - 1.0) / (m_B - 1.0) <= t / m_B) {
+                return static_cast<int>(x);
+            }
+        }
     }
 
-    double getRandomDouble() override {
-        // TODO: implement this. (Zeta distribution)
-        return 0.0;
+    double getRandomDouble(RandomStream &a_Generator) override {
+        return static_cast<double>(getRandomInteger(a_Generator));
     }
 };
 
-class ExponentialDistribution : public RandomDistribution {
+class ExponentialDistribution final : public BatchDistribution<ExponentialDistribution> {
 private:
     const double m_Rate;
     const double m_Scale;
-    std::exponential_distribution<double> m_Distribution;
 public:
     explicit ExponentialDistribution(double a_Scale)
-            : RandomDistribution("exponential"),
+            : BatchDistribution("exponential"),
               m_Rate(1.0 / a_Scale),
-              m_Scale(a_Scale),
-              m_Distribution(1.0 / a_Scale) {
+              m_Scale(a_Scale) {
         assert(!std::isnan(m_Rate));
         assert(m_Rate > 0.0);
         assert(!std::isnan(m_Scale));
@@ -239,26 +551,40 @@ public:
         return m_Scale;
     }
 
-    int getRandomInteger() override {
-        return static_cast<int>(std::round(getRandomDouble()));
+    double getVariance() const override {
+        return m_Scale * m_Scale;
+    }
+
+    int getRandomInteger(RandomStream &a_Generator) override {
+        return static_cast<int>(std::round(getRandomDouble(a_Generator)));
+    }
+
+    double getRandomDouble(RandomStream &a_Generator) override {
+        return sampleExponential(a_Generator, m_Scale);
     }
 
-    double getRandomDouble() override {
-        return m_Distribution(m_Generator);
+    void getRandomIntegers(RandomStream &a_Generator, int *const a_Values, const size_t a_Count) override {
+        roundBatch(a_Values, a_Count, [this, &a_Generator](double *const a_Doubles, const size_t a_DoubleCount) {
+            getRandomDoubles(a_Generator, a_Doubles, a_DoubleCount);
+        });
+    }
+
+    void getRandomDoubles(RandomStream &a_Generator, double *const a_Values, const size_t a_Count) override {
+        sampleExponentials(a_Generator, m_Scale, a_Values, a_Count);
     }
 };
 
-class LogNormalDistribution : public RandomDistribution {
+class LogNormalDistribution final : public BatchDistribution<LogNormalDistribution> {
 private:
     const double m_Mean;
+    const double m_LogMean;
     const double m_StandardDeviation;
-    std::lognormal_distribution<double> m_Distribution;
 public:
     LogNormalDistribution(double a_Mean, double a_StandardDeviation)
-            : RandomDistribution("lognormal"),
+            : BatchDistribution("lognormal"),
               m_Mean(std::exp(a_Mean + ((a_StandardDeviation * a_StandardDeviation) / 2.0))),
-              m_StandardDeviation(a_StandardDeviation),
-              m_Distribution(a_Mean, a_StandardDeviation) {
+              m_LogMean(a_Mean),
+              m_StandardDeviation(a_StandardDeviation) {
         assert(!std::isnan(m_Mean));
         assert(!std::isnan(m_StandardDeviation));
         assert(m_StandardDeviation > 0.0);
@@ -268,12 +594,27 @@ public:
         return m_Mean;
     }
 
-    int getRandomInteger() override {
-        return static_cast<int>(std::round(getRandomDouble()));
+    double getVariance() const override {
+        const double variance = m_StandardDeviation * m_StandardDeviation;
+        return std::expm1(variance) * std::exp(2.0 * m_LogMean + variance);
+    }
+
+    int getRandomInteger(RandomStream &a_Generator) override {
+        return static_cast<int>(std::round(getRandomDouble(a_Generator)));
+    }
+
+    double getRandomDouble(RandomStream &a_Generator) override {
+        return sampleLogNormal(a_Generator, m_LogMean, m_StandardDeviation);
+    }
+
+    void getRandomIntegers(RandomStream &a_Generator, int *const a_Values, const size_t a_Count) override {
+        roundBatch(a_Values, a_Count, [this, &a_Generator](double *const a_Doubles, const size_t a_DoubleCount) {
+            getRandomDoubles(a_Generator, a_Doubles, a_DoubleCount);
+        });
     }
 
-    double getRandomDouble() override {
-        return m_Distribution(m_Generator);
+    void getRandomDoubles(RandomStream &a_Generator, double *const a_Values, const size_t a_Count) override {
+        sampleLogNormals(a_Generator, m_LogMean, m_StandardDeviation, a_Values, a_Count);
     }
 };
 
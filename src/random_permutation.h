@@ -0,0 +1,59 @@
+#ifndef GMARK_RANDOM_PERMUTATION_H
+#define GMARK_RANDOM_PERMUTATION_H
+
+#include <array>
+#include <cassert>
+#include "random_stream.h"
+
+// A keyed pseudorandom permutation of [0, size). It is a balanced Feistel network over the smallest even number
+// of bits that covers the domain, and indices that land outside the domain are encrypted again until they fall
+// inside it (cycle-walking). Since the domain fills at least a quarter of the Feistel block, fewer than four rounds
+// of walking are needed on average. The permutation needs O(1) memory and every index can be mapped independently.
+class FeistelPermutation {
+private:
+    static const size_t m_NrOfRounds = 4;
+
+    uint64_t m_Size = 0;
+    unsigned int m_HalfBits = 1;
+    uint64_t m_HalfMask = 1;
+    std::array<uint64_t, m_NrOfRounds> m_Keys{};
+
+    uint64_t encrypt(const uint64_t a_Value) const {
+        uint64_t left = a_Value >> m_HalfBits;
+        uint64_t right = a_Value & m_HalfMask;
+        for (const uint64_t key : m_Keys) {
+            const uint64_t next = left ^ (RandomStream::mix64(right ^ key) & m_HalfMask);
+            left = right;
+            right = next;
+        }
+        return (left << m_HalfBits) | right;
+    }
+
+public:
+    FeistelPermutation() = default;
+
+    FeistelPermutation(const uint64_t a_Size, RandomStream a_Stream) : m_Size(a_Size) {
+        while (m_HalfBits < 32 && (1ULL << (2 * m_HalfBits)) < m_Size) {
+            ++m_HalfBits;
+        }
+        m_HalfMask = (1ULL << m_HalfBits) - 1;
+        for (auto &key : m_Keys) {
+            key = a_Stream();
+        }
+    }
+
+    uint64_t getSize() const {
+        return m_Size;
+    }
+
+    uint64_t operator()(const uint64_t a_Index) const {
+        assert(a_Index < m_Size);
+        uint64_t value = a_Index;
+        do {
+            value = encrypt(value);
+        } while (value >= m_Size);
+        return value;
+    }
+};
+
+#endif //GMARK_RANDOM_PERMUTATION_H
@@ -0,0 +1,110 @@
+#ifndef GMARK_RANDOM_STREAM_H
+#define GMARK_RANDOM_STREAM_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+// A splittable, counter-based random number generator in the style of SplittableRandom. The n-th value of a
+// stream is a bijective mix of seed + n * gamma, so every value depends only on the stream and its position.
+// Independent child streams are derived with split(), which makes the output of any relation, attribute or node
+// range depend only on the root seed and the identity of the stream, not on the order in which streams are used.
+// The class satisfies the UniformRandomBitGenerator requirements, so it can drive the std:: distributions.
+class RandomStream {
+private:
+    static constexpr uint64_t m_GoldenGamma = 0x9e3779b97f4a7c15ULL;
+
+    uint64_t m_Seed;
+    uint64_t m_Gamma;
+    uint64_t m_Counter = 0;
+
+    // Gammas must be odd and should not have too few bit transitions, otherwise neighbouring values correlate.
+    static constexpr uint64_t mixGamma(uint64_t a_Value) {
+        a_Value = mix64(a_Value) | 1U;
+        const auto transitions = static_cast<unsigned int>(__builtin_popcountll(a_Value ^ (a_Value >> 1U)));
+        return transitions < 24 ? a_Value ^ 0xaaaaaaaaaaaaaaaaULL : a_Value;
+    }
+
+    RandomStream(const uint64_t a_Seed, const uint64_t a_Gamma) : m_Seed(a_Seed), m_Gamma(a_Gamma) {}
+
+public:
+    using result_type = uint64_t;
+
+    // The SplitMix64 finalizer, a bijective mixing function on 64-bit values.
+    static constexpr uint64_t mix64(uint64_t a_Value) {
+        a_Value = (a_Value ^ (a_Value >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+        a_Value = (a_Value ^ (a_Value >> 27U)) * 0x94d049bb133111ebULL;
+        return a_Value ^ (a_Value >> 31U);
+    }
+
+    // FNV-1a, which is stable across platforms unlike std::hash.
+    static constexpr uint64_t hashString(const std::string_view a_Value) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char character : a_Value) {
+            hash = (hash ^ static_cast<unsigned char>(character)) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // Node ranges are drawn in blocks of this many nodes, each from its own child stream. The block size is
+    // fixed, so the values of a node do not depend on the number of threads or the partitioning of the range.
+    static constexpr uint64_t m_NodesPerStream = 1U << 16U;
+
+    explicit RandomStream(const uint64_t a_Seed) : m_Seed(mix64(a_Seed)), m_Gamma(m_GoldenGamma) {}
+
+    static constexpr result_type min() {
+        return std::numeric_limits<result_type>::min();
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        return mix64(m_Seed + ++m_Counter * m_Gamma);
+    }
+
+    // A uniform integer in [0, a_Bound) without modulo bias, drawn from the high 32 bits of the next value, see
+    // Lemire, "Fast Random Integer Generation in an Interval". Values are only drawn again in rare cases.
+    uint32_t getBoundedInteger(const uint32_t a_Bound) {
+        uint64_t product = ((*this)() >> 32U) * a_Bound;
+        auto low = static_cast<uint32_t>(product);
+        if (low < a_Bound) {
+            const uint32_t threshold = static_cast<uint32_t>(-a_Bound) % a_Bound;
+            while (low < threshold) {
+                product = ((*this)() >> 32U) * a_Bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32U);
+    }
+
+    // The number of values drawn so far, so the next value is at(getPosition()).
+    uint64_t getPosition() const {
+        return m_Counter;
+    }
+
+    // Advances the stream as if a_Count values were drawn.
+    void discard(const uint64_t a_Count) {
+        m_Counter += a_Count;
+    }
+
+    // The value at a_Position, without advancing the stream.
+    result_type at(const uint64_t a_Position) const {
+        return mix64(m_Seed + (a_Position + 1) * m_Gamma);
+    }
+
+    // Derives an independent child stream. The child only depends on this stream's seed and a_StreamId, not on
+    // how many values have been drawn from this stream.
+    RandomStream split(const uint64_t a_StreamId) const {
+        const uint64_t base = mix64(m_Seed ^ mix64(a_StreamId * m_GoldenGamma + m_Gamma));
+        return RandomStream(mix64(base), mixGamma(base + m_GoldenGamma));
+    }
+
+    RandomStream split(const std::string &a_StreamName) const {
+        return split(hashString(a_StreamName));
+    }
+};
+
+#endif //GMARK_RANDOM_STREAM_H
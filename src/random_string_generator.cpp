@@ -14,169 +14,239 @@ RandomStringGenerator::RandomStringGenerator(const std::string &a_Regex, const i
     m_Subpattern = parser.parse(a_Regex);
 }
 
-std::string RandomStringGenerator::getRandomString() {
-    std::wstring new_string;
+void RandomStringGenerator::appendRandomString(RandomStream &a_Generator, std::string &a_Output,
+                                               RealizedGroups &a_RealizedGroups) const {
+    a_RealizedGroups.clear();
+    Realization realization{a_Output, a_Output.size(), a_RealizedGroups};
     for (int i = 0; i < m_Subpattern->length(); ++i) {
-        new_string += handleOpcode(m_Subpattern->getItem(i));
+        handleOpcode(a_Generator, m_Subpattern->getItem(i), realization);
     }
-    return m_Converter.to_bytes(new_string);
 }
 
-const std::wstring RandomStringGenerator::handleOpcode(const std::shared_ptr<const Opcode> &a_Opcode) {
+void RandomStringGenerator::appendCharacter(const wchar_t a_Character, Realization &a_Realization) {
+    // The characters are UTF-16 code units, as the regex is decoded with std::codecvt_utf8_utf16.
+    auto code_point = static_cast<uint32_t>(a_Character);
+    std::string &output = a_Realization.m_Output;
+    if (code_point >= 0xDC00U && code_point <= 0xDFFFU && output.size() >= a_Realization.m_Start + 3) {
+        const auto *const last = reinterpret_cast<const unsigned char *>(output.data() + output.size() - 3);
+        if (last[0] == 0xEDU && (last[1] & 0xF0U) == 0xA0U) {
+            // A low surrogate that follows a high surrogate: replace the pair by the code point it encodes.
+            const uint32_t high = 0xD000U | (static_cast<uint32_t>(last[1] & 0x3FU) << 6U) | (last[2] & 0x3FU);
+            output.resize(output.size() - 3);
+            code_point = 0x10000U + ((high - 0xD800U) << 10U) + (code_point - 0xDC00U);
+        }
+    }
+    if (code_point < 0x80U) {
+        output += static_cast<char>(code_point);
+    } else if (code_point < 0x800U) {
+        output += static_cast<char>(0xC0U | (code_point >> 6U));
+        output += static_cast<char>(0x80U | (code_point & 0x3FU));
+    } else if (code_point < 0x10000U) {
+        output += static_cast<char>(0xE0U | (code_point >> 12U));
+        output += static_cast<char>(0x80U | ((code_point >> 6U) & 0x3FU));
+        output += static_cast<char>(0x80U | (code_point & 0x3FU));
+    } else {
+        output += static_cast<char>(0xF0U | (code_point >> 18U));
+        output += static_cast<char>(0x80U | ((code_point >> 12U) & 0x3FU));
+        output += static_cast<char>(0x80U | ((code_point >> 6U) & 0x3FU));
+        output += static_cast<char>(0x80U | (code_point & 0x3FU));
+    }
+}
+
+void RandomStringGenerator::handleOpcode(RandomStream &a_Generator, const std::shared_ptr<const Opcode> &a_Opcode,
+                                         Realization &a_Realization) const {
     const std::string &opcode_name = a_Opcode->getName();
     if (opcode_name == "LITERAL") {
         const auto literal = std::dynamic_pointer_cast<const Literal>(a_Opcode);
-        return std::wstring(1, literal->getLiteral());
+        appendCharacter(literal->getLiteral(), a_Realization);
+        return;
     }
     if (opcode_name == "NOT_LITERAL") {
         const auto not_literal = std::dynamic_pointer_cast<const NotLiteral>(a_Opcode);
         const auto not_this = not_literal->getLiteral();
-        return getRandomPrintableCharacter(not_this);
+        appendCharacter(getRandomPrintableCharacter(a_Generator, not_this), a_Realization);
+        return;
     }
     if (opcode_name == "AT") {
-        return L""; // TODO(thom): How to handle AT?
+        return; // TODO(thom): How to handle AT?
     }
     if (opcode_name == "IN") {
         const auto in = std::dynamic_pointer_cast<const In>(a_Opcode);
-        return handleIn(in);
+        handleIn(a_Generator, in, a_Realization);
+        return;
     }
     if (opcode_name == "ANY") {
         // TODO(thom): Also do not generate other whitespace?
-        return getRandomPrintableCharacter('\n');
+        appendCharacter(getRandomPrintableCharacter(a_Generator, '\n'), a_Realization);
+        return;
     }
     if (opcode_name == "RANGE") {
         const auto range = std::dynamic_pointer_cast<const Range>(a_Opcode);
         std::uniform_int_distribution<int> distribution(range->getLow(), range->getHigh());
-        int code_point = distribution(m_Generator);
-        return std::wstring(1, static_cast<wchar_t>(code_point));
+        int code_point = distribution(a_Generator);
+        appendCharacter(static_cast<wchar_t>(code_point), a_Realization);
+        return;
     }
     if (opcode_name == "CATEGORY") {
         const auto category = std::dynamic_pointer_cast<const Category>(a_Opcode);
         auto name = category->getCategory();
         if (name == E_CATEGORY_TYPE::CATEGORY_DIGIT) {
-            return getRandomCharacter(m_Digits);
+            appendCharacter(getRandomCharacter(a_Generator, m_Digits), a_Realization);
+            return;
         }
         if (name == E_CATEGORY_TYPE::CATEGORY_NOT_DIGIT) {
-            return getRandomCharacter(m_NonDigits);
+            appendCharacter(getRandomCharacter(a_Generator, m_NonDigits), a_Realization);
+            return;
         }
         if (name == E_CATEGORY_TYPE::CATEGORY_SPACE) {
-            return getRandomCharacter(m_Whitespace);
+            appendCharacter(getRandomCharacter(a_Generator, m_Whitespace), a_Realization);
+            return;
         }
         if (name == E_CATEGORY_TYPE::CATEGORY_NOT_SPACE) {
-            return getRandomCharacter(m_NonWhitespace);
+            appendCharacter(getRandomCharacter(a_Generator, m_NonWhitespace), a_Realization);
+            return;
         }
         if (name == E_CATEGORY_TYPE::CATEGORY_WORD) {
-            return getRandomCharacter(m_Word);
+            appendCharacter(getRandomCharacter(a_Generator, m_Word), a_Realization);
+            return;
         }
         if (name == E_CATEGORY_TYPE::CATEGORY_NOT_WORD) {
-            return getRandomCharacter(m_NonWord);
+            appendCharacter(getRandomCharacter(a_Generator, m_NonWord), a_Realization);
+            return;
         }
         throw std::invalid_argument("This category is not supported yet.");
     }
     if (opcode_name == "BRANCH") {
         const auto branch = std::dynamic_pointer_cast<const Branch>(a_Opcode);
         std::uniform_int_distribution<int> distribution(0, branch->length() - 1);
-        return handleSubpattern(branch->getItem(distribution(m_Generator)));
+        handleSubpattern(a_Generator, branch->getItem(distribution(a_Generator)), a_Realization);
+        return;
     }
     if (opcode_name == "SUBPATTERN") {
         const auto subpattern = std::dynamic_pointer_cast<const SubpatternOpcode>(a_Opcode);
-        return handleGroup(subpattern->getSubpattern(), subpattern->getGroup());
+        handleGroup(a_Generator, subpattern->getSubpattern(), subpattern->getGroup(), a_Realization);
+        return;
     }
     if (opcode_name == "ASSERT") {
-        std::wstring result;
         const auto assert = std::dynamic_pointer_cast<const Assert>(a_Opcode);
         const auto &subpattern = assert->getSubpattern();
         for (int i = 0; i < subpattern.length(); ++i) {
-            result += handleOpcode(subpattern.getItem(i));
+            handleOpcode(a_Generator, subpattern.getItem(i), a_Realization);
         }
-        return result;
+        return;
     }
     if (opcode_name == "ASSERT_NOT") {
         // TODO(thom): How do we handle this case? Assert that a piece of text does *not* exist.
-        return L"";
+        return;
     } if (opcode_name == "GROUPREF") {
         const auto groupRef = std::dynamic_pointer_cast<const GroupRef>(a_Opcode);
-        return m_RealizedGroups.at(groupRef->getGroupId());
+        const auto group_id = static_cast<size_t>(groupRef->getGroupId());
+        const auto &groups = a_Realization.m_RealizedGroups;
+        if (group_id >= groups.size() || groups[group_id].first == m_NoGroup) {
+            throw std::out_of_range("Reference to a group that has not been generated.");
+        }
+        // Appending a substring of the output to itself is safe, even when the output has to grow.
+        a_Realization.m_Output.append(a_Realization.m_Output, groups[group_id].first,
+                                      groups[group_id].second - groups[group_id].first);
+        return;
     } if (opcode_name == "MIN_REPEAT") {
         const auto min_repeat = std::dynamic_pointer_cast<const MinRepeat>(a_Opcode);
-        return handleRepeat(min_repeat->getMin(), min_repeat->getMax(), min_repeat->getSubpattern());
+        handleRepeat(a_Generator, min_repeat->getMin(), min_repeat->getMax(), min_repeat->getSubpattern(),
+                     a_Realization);
+        return;
     } if (opcode_name == "MAX_REPEAT") {
         const auto max_repeat = std::dynamic_pointer_cast<const MaxRepeat>(a_Opcode);
-        return handleRepeat(max_repeat->getMin(), max_repeat->getMax(), max_repeat->getSubpattern());
+        handleRepeat(a_Generator, max_repeat->getMin(), max_repeat->getMax(), max_repeat->getSubpattern(),
+                     a_Realization);
+        return;
     }
     throw std::invalid_argument("Unexpected opcode! " + opcode_name);
 }
 
-const std::wstring RandomStringGenerator::handleIn(const std::shared_ptr<const In> &a_InOpcode) {
+void RandomStringGenerator::handleIn(RandomStream &a_Generator, const std::shared_ptr<const In> &a_InOpcode,
+                                     Realization &a_Realization) const {
     assert(a_InOpcode->length() > 0);
     bool negate = a_InOpcode->getItem(0)->getName() == "NEGATE";
     if (negate) {
         throw std::invalid_argument("Negative character classes not supported yet.");
     }
-    return chooseFromCharacterClass(a_InOpcode);
+    chooseFromCharacterClass(a_Generator, a_InOpcode, a_Realization);
 }
 
-const std::wstring RandomStringGenerator::chooseFromCharacterClass(const std::shared_ptr<const In> &a_InOpcode) {
+void RandomStringGenerator::chooseFromCharacterClass(RandomStream &a_Generator,
+                                                     const std::shared_ptr<const In> &a_InOpcode,
+                                                     Realization &a_Realization) const {
     // In consists of ranges, categories and literals.
     int nr_choices = 0;
-    std::vector<int> lookup(static_cast<size_t>(a_InOpcode->length()));
     for (int i = 0; i < a_InOpcode->length(); ++i) {
         nr_choices += a_InOpcode->getItem(i)->minNrCharacters();
-        lookup[static_cast<size_t>(i)] = nr_choices;
     }
     assert(nr_choices > 0);
     std::uniform_int_distribution<int> distribution(0, nr_choices - 1);
-    int character_choice = distribution(m_Generator);
-    auto lower_bound_iterator = std::lower_bound(lookup.begin(), lookup.end(), character_choice);
-    auto choice_index = std::distance(lookup.begin(), lower_bound_iterator);
-    return handleOpcode(a_InOpcode->getItem(static_cast<int>(choice_index)));
+    int character_choice = distribution(a_Generator);
+    // The first item whose running total of characters reaches the choice.
+    int choice_index = 0;
+    for (int total = a_InOpcode->getItem(0)->minNrCharacters(); total < character_choice;
+         total += a_InOpcode->getItem(choice_index)->minNrCharacters()) {
+        ++choice_index;
+    }
+    handleOpcode(a_Generator, a_InOpcode->getItem(choice_index), a_Realization);
 }
 
-const std::wstring RandomStringGenerator::handleSubpattern(const std::shared_ptr<const Subpattern> &a_Subpattern) {
-    std::wstring result;
+void RandomStringGenerator::handleSubpattern(RandomStream &a_Generator,
+                                             const std::shared_ptr<const Subpattern> &a_Subpattern,
+                                             Realization &a_Realization) const {
     for (int i = 0; i < a_Subpattern->length(); ++i) {
-        result += handleOpcode(a_Subpattern->getItem(i));
+        handleOpcode(a_Generator, a_Subpattern->getItem(i), a_Realization);
     }
-    return result;
 }
 
-const std::wstring RandomStringGenerator::handleGroup(const std::shared_ptr<const Subpattern> &a_Subpattern, int a_Group) {
-    std::wstring result = handleSubpattern(a_Subpattern);
-    m_RealizedGroups[a_Group] = result;
-    return result;
+void RandomStringGenerator::handleGroup(RandomStream &a_Generator,
+                                        const std::shared_ptr<const Subpattern> &a_Subpattern, int a_Group,
+                                        Realization &a_Realization) const {
+    const size_t start = a_Realization.m_Output.size();
+    handleSubpattern(a_Generator, a_Subpattern, a_Realization);
+    auto &groups = a_Realization.m_RealizedGroups;
+    const auto group_id = static_cast<size_t>(a_Group);
+    if (group_id >= groups.size()) {
+        groups.resize(group_id + 1, {m_NoGroup, m_NoGroup});
+    }
+    groups[group_id] = {start, a_Realization.m_Output.size()};
 }
 
-const std::wstring RandomStringGenerator::handleRepeat(int a_Min, int a_Max, const std::shared_ptr<const Subpattern> &a_Subpattern) {
-    std::wstring result;
+void RandomStringGenerator::handleRepeat(RandomStream &a_Generator,
+                                         int a_Min, int a_Max, const std::shared_ptr<const Subpattern> &a_Subpattern,
+                                         Realization &a_Realization) const {
     a_Max = std::max(a_Min, std::min(a_Max, m_RepeatLimit));
     std::uniform_int_distribution<int> distribution(a_Min, a_Max);
-    int times = distribution(m_Generator);
+    int times = distribution(a_Generator);
     for (int i = times; i > 0; --i) {
         for (int k = 0; k < a_Subpattern->length(); ++k) {
-            result += handleOpcode(a_Subpattern->getItem(k));
+            handleOpcode(a_Generator, a_Subpattern->getItem(k), a_Realization);
         }
     }
-    return result;
 }
 
-const std::wstring RandomStringGenerator::getRandomPrintableCharacter(const wchar_t a_NotThisCharacter) {
+wchar_t RandomStringGenerator::getRandomPrintableCharacter(RandomStream &a_Generator,
+                                                                      const wchar_t a_NotThisCharacter) const {
     while (true) {
-        size_t random_index = m_PrintableDistribution(m_Generator);
+        auto distribution = m_PrintableDistribution;
+        size_t random_index = distribution(a_Generator);
         auto iterator = m_Printable.begin();
         std::advance(iterator, random_index);
         wchar_t character = *iterator;
         if (character != a_NotThisCharacter) {
-            return std::wstring(1, character);
+            return character;
         }
     }
 }
 
-const std::wstring RandomStringGenerator::getRandomCharacter(const std::unordered_set<wchar_t> &a_CharacterSet) {
+wchar_t RandomStringGenerator::getRandomCharacter(RandomStream &a_Generator,
+                                                             const std::unordered_set<wchar_t> &a_CharacterSet) const {
     assert(!a_CharacterSet.empty());
     auto distribution = std::uniform_int_distribution<size_t>(0, a_CharacterSet.size() - 1);
-    size_t random_index = distribution(m_Generator);
+    size_t random_index = distribution(a_Generator);
     auto iterator = a_CharacterSet.begin();
     std::advance(iterator, random_index);
-    wchar_t character = *iterator;
-    return std::wstring(1, character);
+    return *iterator;
 }
@@ -4,20 +4,18 @@
 #include <string>
 #include <random>
 #include <locale>
-#include <unordered_map>
 #include <unordered_set>
-#include <codecvt>
+#include <limits>
+#include <vector>
 #include "regex_parser/subpattern.h"
 #include "regex_parser/in.h"
+#include "random_stream.h"
 
 class RandomStringGenerator {
 protected:
     const std::string m_Regex;
     const int m_RepeatLimit;
-    std::mt19937 m_Generator{std::random_device{}()};
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> m_Converter;
     std::shared_ptr<Subpattern> m_Subpattern;
-    std::unordered_map<int, std::wstring> m_RealizedGroups;
     const std::unordered_set<wchar_t> m_Printable = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c',
                                                      'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p',
                                                      'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', 'A', 'B', 'C',
@@ -53,26 +51,53 @@ protected:
                                                    '-', '.', '/', ':', ';', '<', '=', '>', '?', '@', '[', ']', '^',
                                                    '_', '`', '{', '|', '}', '~', ' ', '\t', '\n', '\r', '\x0b', '\x0c'};
 
-    const std::wstring handleOpcode(const std::shared_ptr<const Opcode> &a_Opcode);
+    static constexpr size_t m_NoGroup = std::numeric_limits<size_t>::max();
 
-    const std::wstring handleIn(const std::shared_ptr<const In> &a_InOpcode);
+public:
+    // The byte ranges in the output of the groups that have been generated so far, indexed by group id, so that a
+    // back reference repeats its group. Groups that have not been generated are {m_NoGroup, m_NoGroup}.
+    using RealizedGroups = std::vector<std::pair<size_t, size_t>>;
+
+protected:
+    // The state of one call of appendRandomString. The string starts at m_Start in m_Output.
+    struct Realization {
+        std::string &m_Output;
+        const size_t m_Start;
+        RealizedGroups &m_RealizedGroups;
+    };
+
+    // Appends a UTF-16 code unit as UTF-8 and joins it with a preceding high surrogate.
+    static void appendCharacter(const wchar_t a_Character, Realization &a_Realization);
+
+    void handleOpcode(RandomStream &a_Generator, const std::shared_ptr<const Opcode> &a_Opcode,
+                      Realization &a_Realization) const;
+
+    void handleIn(RandomStream &a_Generator, const std::shared_ptr<const In> &a_InOpcode,
+                  Realization &a_Realization) const;
 
-    const std::wstring chooseFromCharacterClass(const std::shared_ptr<const In> &a_InOpcode);
+    void chooseFromCharacterClass(RandomStream &a_Generator, const std::shared_ptr<const In> &a_InOpcode,
+                                  Realization &a_Realization) const;
 
-    const std::wstring handleSubpattern(const std::shared_ptr<const Subpattern> &a_Subpattern);
+    void handleSubpattern(RandomStream &a_Generator, const std::shared_ptr<const Subpattern> &a_Subpattern,
+                          Realization &a_Realization) const;
 
-    const std::wstring handleGroup(const std::shared_ptr<const Subpattern> &a_Subpattern, int a_Group);
+    void handleGroup(RandomStream &a_Generator, const std::shared_ptr<const Subpattern> &a_Subpattern, int a_Group,
+                     Realization &a_Realization) const;
 
-    const std::wstring handleRepeat(int a_Min, int a_Max, const std::shared_ptr<const Subpattern> &a_Subpattern);
+    void handleRepeat(RandomStream &a_Generator, int a_Min, int a_Max,
+                      const std::shared_ptr<const Subpattern> &a_Subpattern, Realization &a_Realization) const;
 
-    const std::wstring getRandomPrintableCharacter(const wchar_t a_NotThisCharacter);
+    wchar_t getRandomPrintableCharacter(RandomStream &a_Generator, const wchar_t a_NotThisCharacter) const;
 
-    const std::wstring getRandomCharacter(const std::unordered_set<wchar_t> &a_CharacterSet);
+    wchar_t getRandomCharacter(RandomStream &a_Generator, const std::unordered_set<wchar_t> &a_CharacterSet) const;
 
 public:
     explicit RandomStringGenerator(const std::string &a_Regex, const int a_RepeatLimit = 999);
 
-    std::string getRandomString();
+    // Appends a random string to a_Output as UTF-8. a_RealizedGroups is scratch space, which can be reused from one
+    // call to the next so that generating a string does not allocate once the output has grown large enough. Safe
+    // to call from several threads at once.
+    void appendRandomString(RandomStream &a_Generator, std::string &a_Output, RealizedGroups &a_RealizedGroups) const;
 };
 
 
@@ -0,0 +1,85 @@
+#include "sampling_kernels.h"
+#include <algorithm>
+#include <array>
+
+// GCC and clang both clone the kernels for the listed instruction sets and pick one when the program is loaded.
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define GMARK_VECTOR_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#ifndef GMARK_VECTOR_KERNEL
+#define GMARK_VECTOR_KERNEL
+#endif
+
+// The loops are vectorised at every optimisation level, which -fopenmp-simd enables without the OpenMP runtime. The
+// iterations are independent and nothing is reassociated, so the vectorised loops give the same values. The
+// transcendental functions are inlined polynomials, so the whole transform runs in vector registers.
+#define GMARK_VECTOR_LOOP _Pragma("omp simd")
+
+// The values are transformed in tiles of this many values, whose uniforms stay in the L1 cache.
+static constexpr size_t g_TileSize = 256;
+
+GMARK_VECTOR_KERNEL
+void sampleUniforms(RandomStream &a_Generator, double *const a_Values, const size_t a_Count) {
+    // The stream is counter-based, so every value only depends on its position and the loop has no dependencies.
+    const RandomStream generator = a_Generator;
+    const uint64_t position = generator.getPosition();
+    GMARK_VECTOR_LOOP
+    for (size_t i = 0; i < a_Count; ++i) {
+        a_Values[i] = toUniformDouble(generator.at(position + i));
+    }
+    a_Generator.discard(a_Count);
+}
+
+GMARK_VECTOR_KERNEL
+void sampleGaussians(RandomStream &a_Generator, const double a_Mean, const double a_StandardDeviation,
+                     double *const a_Values, const size_t a_Count) {
+    // A draw at an odd position completes the pair of the draw before it, so it is drawn on its own. Then every
+    // pair of uniforms gives two values.
+    const size_t head = a_Count > 0 && a_Generator.getPosition() % 2 == 1 ? 1 : 0;
+    if (head == 1) {
+        a_Values[0] = sampleGaussian(a_Generator, a_Mean, a_StandardDeviation);
+    }
+    double *const values = a_Values + head;
+    const size_t nr_pairs = (a_Count - head) / 2;
+    RandomStream gaussian_stream = getGaussianStream(a_Generator);
+    gaussian_stream.discard(a_Generator.getPosition());
+    std::array<double, 2 * g_TileSize> uniforms{};
+    for (size_t first = 0; first < nr_pairs; first += g_TileSize) {
+        const size_t count = std::min(g_TileSize, nr_pairs - first);
+        sampleUniforms(gaussian_stream, uniforms.data(), 2 * count);
+        GMARK_VECTOR_LOOP
+        for (size_t i = 0; i < count; ++i) {
+            double cosine;
+            double sine;
+            toGaussianPair(uniforms[2 * i], uniforms[2 * i + 1], cosine, sine);
+            values[2 * (first + i)] = a_Mean + a_StandardDeviation * cosine;
+            values[2 * (first + i) + 1] = a_Mean + a_StandardDeviation * sine;
+        }
+    }
+    a_Generator.discard(2 * nr_pairs);
+    if (head + 2 * nr_pairs < a_Count) {
+        a_Values[a_Count - 1] = sampleGaussian(a_Generator, a_Mean, a_StandardDeviation);
+    }
+}
+
+GMARK_VECTOR_KERNEL
+void sampleExponentials(RandomStream &a_Generator, const double a_Scale, double *const a_Values,
+                        const size_t a_Count) {
+    sampleUniforms(a_Generator, a_Values, a_Count);
+    GMARK_VECTOR_LOOP
+    for (size_t i = 0; i < a_Count; ++i) {
+        a_Values[i] = toExponential(a_Values[i], a_Scale);
+    }
+}
+
+GMARK_VECTOR_KERNEL
+void sampleLogNormals(RandomStream &a_Generator, const double a_Mean, const double a_StandardDeviation,
+                      double *const a_Values, const size_t a_Count) {
+    sampleGaussians(a_Generator, a_Mean, a_StandardDeviation, a_Values, a_Count);
+    GMARK_VECTOR_LOOP
+    for (size_t i = 0; i < a_Count; ++i) {
+        a_Values[i] = portableExp(a_Values[i]);
+    }
+}
@@ -0,0 +1,192 @@
+#ifndef GMARK_SAMPLING_KERNELS_H
+#define GMARK_SAMPLING_KERNELS_H
+
+#include <cmath>
+#include <cstring>
+#include "random_stream.h"
+
+// Samplers for the continuous distributions that work on plain arrays, so that a batch of values can be drawn with
+// vector instructions. Each value is computed from the same uniforms with the same formula as the single draws
+// below, so a batch gives exactly the same values as the same number of single draws. The kernels are compiled for
+// several instruction sets and the best one is chosen at runtime, with a plain x86-64 or non-x86 build as the
+// fallback. The logarithm, exponential and sine and cosine are the polynomial approximations below rather than
+// those of the C library. They only add, subtract, multiply, divide and move bits, which IEEE 754 rounds the same
+// on every instruction set as long as nothing is contracted, so the values of a seed do not depend on the machine.
+
+// Reinterprets a double as its bits and back. The copies compile to register moves, also in vector loops.
+inline uint64_t toBits(const double a_Value) {
+    uint64_t bits;
+    std::memcpy(&bits, &a_Value, sizeof(bits));
+    return bits;
+}
+
+inline double fromBits(const uint64_t a_Bits) {
+    double value;
+    std::memcpy(&value, &a_Bits, sizeof(value));
+    return value;
+}
+
+// A uniform double in [0, 1) from the top 52 bits of a value of the stream. The bits become the mantissa of a
+// double in [1, 2), which unlike an integer conversion is available on every vector instruction set.
+inline double toUniformDouble(const uint64_t a_Value) {
+    return fromBits((a_Value >> 12U) | 0x3ff0000000000000ULL) - 1.0;
+}
+
+// Adding this to a double of magnitude below 2^51 rounds it to an integer, which ends up in the low bits.
+static constexpr double g_RoundingShift = 6755399441055744.0; // 1.5 * 2^52
+static constexpr uint64_t g_RoundingShiftBits = 0x4338000000000000ULL;
+
+// The natural logarithm of a positive normal double, within an ulp. The argument is split into 2^k * z with z in
+// [sqrt(2) / 2, sqrt(2)), and log(z) is evaluated with the polynomial of fdlibm's log in s = (z - 1) / (z + 1).
+inline double portableLog(const double a_Value) {
+    constexpr double ln2_hi = 6.93147180369123816490e-01;
+    constexpr double ln2_lo = 1.90821492927058770002e-10;
+    constexpr double lg1 = 6.666666666666735130e-01;
+    constexpr double lg2 = 3.999999999940941908e-01;
+    constexpr double lg3 = 2.857142874366239149e-01;
+    constexpr double lg4 = 2.222219843214978396e-01;
+    constexpr double lg5 = 1.818357216161805012e-01;
+    constexpr double lg6 = 1.531383769920937332e-01;
+    constexpr double lg7 = 1.479819860511658591e-01;
+    const uint64_t bits = toBits(a_Value);
+    // Subtracting the bits of sqrt(2) / 2 carries into the exponent exactly when the mantissa reaches it.
+    const uint64_t exponent_bits = (bits - 0x3fe6a09e667f3bcdULL) & 0xfff0000000000000ULL;
+    const uint64_t z_bits = bits - exponent_bits;
+    // k is formed in the mantissa of 2^52 + k, which avoids an integer conversion.
+    const double k = fromBits(g_RoundingShiftBits | (bits >> 52U)) - fromBits(g_RoundingShiftBits | (z_bits >> 52U));
+    const double f = fromBits(z_bits) - 1.0;
+    const double half_f_squared = 0.5 * f * f;
+    const double s = f / (2.0 + f);
+    const double s2 = s * s;
+    const double s4 = s2 * s2;
+    const double odd = s2 * (lg1 + s4 * (lg3 + s4 * (lg5 + s4 * lg7)));
+    const double even = s4 * (lg2 + s4 * (lg4 + s4 * lg6));
+    const double r = odd + even;
+    return k * ln2_hi - ((half_f_squared - (s * (half_f_squared + r) + k * ln2_lo)) - f);
+}
+
+// The exponential of any double that is not NaN, within an ulp. The argument is split into k * ln(2) + r with
+// |r| <= ln(2) / 2, and exp(r) is evaluated with the rational approximation of fdlibm's exp. The scaling by 2^k
+// is split into two factors, so that it neither overflows nor underflows too early.
+inline double portableExp(const double a_Value) {
+    constexpr double ln2_hi = 6.93147180369123816490e-01;
+    constexpr double ln2_lo = 1.90821492927058770002e-10;
+    constexpr double inverse_ln2 = 1.44269504088896338700e+00;
+    constexpr double p1 = 1.66666666666666019037e-01;
+    constexpr double p2 = -2.77777777770155933842e-03;
+    constexpr double p3 = 6.61375632143793436117e-05;
+    constexpr double p4 = -1.65339022054652515390e-06;
+    constexpr double p5 = 4.13813679705723846039e-08;
+    // Beyond 746 in magnitude the result is infinite or zero anyway. The magnitude is clamped on its bits, whose
+    // integer order is that of the doubles, because the compiler does not vectorise selects on doubles that may
+    // trap.
+    const uint64_t sign_bit = 0x8000000000000000ULL;
+    const uint64_t magnitude_bits = toBits(a_Value) & ~sign_bit;
+    const uint64_t limit_bits = toBits(746.0);
+    const double x = fromBits((magnitude_bits < limit_bits ? magnitude_bits : limit_bits) |
+                              (toBits(a_Value) & sign_bit));
+    const double shifted_k = x * inverse_ln2 + g_RoundingShift;
+    const double k = shifted_k - g_RoundingShift;
+    const double hi = x - k * ln2_hi;
+    const double lo = k * ln2_lo;
+    const double r = hi - lo;
+    const double t = r * r;
+    const double c = r - t * (p1 + t * (p2 + t * (p3 + t * (p4 + t * p5))));
+    const double y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+    const uint64_t k_bits = toBits(shifted_k);
+    const uint64_t half_k_bits = toBits(0.5 * k + g_RoundingShift);
+    // Both halves of k stay within [-538, 538], so both factors are normal powers of two.
+    const uint64_t first_scale = (half_k_bits - g_RoundingShiftBits + 1023U) << 52U;
+    const uint64_t second_scale = (k_bits - half_k_bits + 1023U) << 52U;
+    return y * fromBits(first_scale) * fromBits(second_scale);
+}
+
+// The cosine and sine of 2 * pi * a_Turns for a_Turns in [0, 1), within two ulps. The quarter turn is split off
+// exactly, and the rest is evaluated with the polynomials of fdlibm's kernel sine and cosine.
+inline void portableSinCosTurns(const double a_Turns, double &a_Cosine, double &a_Sine) {
+    constexpr double half_pi = 1.57079632679489661923;
+    constexpr double s1 = -1.66666666666666324348e-01;
+    constexpr double s2 = 8.33333333332248946124e-03;
+    constexpr double s3 = -1.98412698298579493134e-04;
+    constexpr double s4 = 2.75573137070700676789e-06;
+    constexpr double s5 = -2.50507602534068634195e-08;
+    constexpr double s6 = 1.58969099521155010221e-10;
+    constexpr double c1 = 4.16666666666666019037e-02;
+    constexpr double c2 = -1.38888888888741095749e-03;
+    constexpr double c3 = 2.48015872894767294178e-05;
+    constexpr double c4 = -2.75573143513906633035e-07;
+    constexpr double c5 = 2.08757232129817482790e-09;
+    constexpr double c6 = -1.13596475577881948265e-11;
+    const double quarters = 4.0 * a_Turns;
+    const double shifted_quarter = quarters + g_RoundingShift;
+    const uint64_t quarter = toBits(shifted_quarter) & 3U;
+    const double x = (quarters - (shifted_quarter - g_RoundingShift)) * half_pi;
+    const double z = x * x;
+    const double sine = x + z * x * (s1 + z * (s2 + z * (s3 + z * (s4 + z * (s5 + z * s6)))));
+    const double half_z = 0.5 * z;
+    const double w = 1.0 - half_z;
+    const double cosine_tail = z * z * (c1 + z * (c2 + z * (c3 + z * (c4 + z * (c5 + z * c6)))));
+    const double cosine = w + (((1.0 - w) - half_z) + cosine_tail);
+    // Rotate by the quarter turns with masks instead of branches: odd quarters swap the two, and the sign bits
+    // flip in the second and third quarter for the cosine and in the third and fourth for the sine.
+    const uint64_t swap_mask = 0U - (quarter & 1U);
+    const uint64_t cosine_bits = (toBits(cosine) & ~swap_mask) | (toBits(sine) & swap_mask);
+    const uint64_t sine_bits = (toBits(sine) & ~swap_mask) | (toBits(cosine) & swap_mask);
+    a_Cosine = fromBits(cosine_bits ^ (((quarter + 1U) & 2U) << 62U));
+    a_Sine = fromBits(sine_bits ^ ((quarter & 2U) << 62U));
+}
+
+// Box-Muller, which turns two uniforms into two independent standard Gaussians.
+inline void toGaussianPair(const double a_First, const double a_Second, double &a_Cosine, double &a_Sine) {
+    const double radius = std::sqrt(-2.0 * portableLog(1.0 - a_First));
+    portableSinCosTurns(a_Second, a_Cosine, a_Sine);
+    a_Cosine *= radius;
+    a_Sine *= radius;
+}
+
+// Inversion with one uniform per value. 1 - a_Uniform is exact, so this is as accurate as log1p.
+inline double toExponential(const double a_Uniform, const double a_Scale) {
+    return -portableLog(1.0 - a_Uniform) * a_Scale;
+}
+
+// The Gaussians at the positions 2k and 2k + 1 of a stream are the two outputs of one Box-Muller transform. Its
+// uniforms are the values 2k and 2k + 1 of a child stream rather than of the stream itself, whose values other
+// draws may use, so a Gaussian never shares its uniforms with a draw of another kind.
+inline RandomStream getGaussianStream(const RandomStream &a_Generator) {
+    constexpr uint64_t stream_id = RandomStream::hashString("gaussian");
+    return a_Generator.split(stream_id);
+}
+
+inline double sampleGaussian(RandomStream &a_Generator, const double a_Mean, const double a_StandardDeviation) {
+    const uint64_t position = a_Generator.getPosition();
+    a_Generator.discard(1);
+    const RandomStream gaussian_stream = getGaussianStream(a_Generator);
+    const uint64_t first = position & ~1ULL;
+    double cosine;
+    double sine;
+    toGaussianPair(toUniformDouble(gaussian_stream.at(first)), toUniformDouble(gaussian_stream.at(first + 1)),
+                   cosine, sine);
+    return a_Mean + a_StandardDeviation * ((position & 1U) == 0 ? cosine : sine);
+}
+
+inline double sampleExponential(RandomStream &a_Generator, const double a_Scale) {
+    return toExponential(toUniformDouble(a_Generator()), a_Scale);
+}
+
+inline double sampleLogNormal(RandomStream &a_Generator, const double a_Mean, const double a_StandardDeviation) {
+    return portableExp(sampleGaussian(a_Generator, a_Mean, a_StandardDeviation));
+}
+
+// Fills a_Values with the uniforms of the next a_Count values of the stream and advances it.
+void sampleUniforms(RandomStream &a_Generator, double *a_Values, size_t a_Count);
+
+void sampleGaussians(RandomStream &a_Generator, double a_Mean, double a_StandardDeviation, double *a_Values,
+                     size_t a_Count);
+
+void sampleExponentials(RandomStream &a_Generator, double a_Scale, double *a_Values, size_t a_Count);
+
+// exp of Gaussians with the given mean and standard deviation of the logarithm.
+void sampleLogNormals(RandomStream &a_Generator, double a_Mean, double a_StandardDeviation, double *a_Values,
+                      size_t a_Count);
+
+#endif //GMARK_SAMPLING_KERNELS_H
@@ -1,13 +1,14 @@
 #include "schema.h"
-#include <fstream>
+#include "category_file.h"
+#include "civil_date.h"
 #include <string>
 
 const std::regex Schema::m_DateRegex(R"(^(\d{4})-(\d{2})-(\d{2})$)");
-const std::regex Schema::m_CSVParseRegex(R"'(^(?:"(.+)"|(.+)),(1|\d\.\d+)$)'");
 const double Schema::m_LenientCategoryProbabilityEpsilon = 0.1;
 
-Schema::Schema(const pugi::xml_node a_TypesNode, const pugi::xml_node a_PredicatesNode, const int a_GraphSize) {
-    getTypes(m_Types, a_TypesNode);
+Schema::Schema(const pugi::xml_node a_TypesNode, const pugi::xml_node a_PredicatesNode, const uint64_t a_GraphSize,
+               ThreadPool &a_ThreadPool) {
+    getTypes(m_Types, a_TypesNode, a_ThreadPool);
     if (m_Types.empty()) {
         throw std::invalid_argument("The graph schema is required to specify node types");
     }
@@ -24,8 +25,8 @@ Schema::Schema(const pugi::xml_node a_TypesNode, const pugi::xml_node a_Predicat
     m_RelationDistributions = getDistributions(a_TypesNode, type_names, m_Predicates, m_Constraints);
 }
 
-std::map<std::string, int> Schema::getConstraints(const pugi::xml_node a_TypesNode, const int a_GraphSize) {
-    std::map<std::string, int> constraints;
+std::map<std::string, uint64_t> Schema::getConstraints(const pugi::xml_node a_TypesNode, const uint64_t a_GraphSize) {
+    std::map<std::string, uint64_t> constraints;
     for (pugi::xml_node type : a_TypesNode.children("type")) {
         std::string name = type.attribute("name").as_string();
         if (name.empty()) {
@@ -35,15 +36,14 @@ std::map<std::string, int> Schema::getConstraints(const pugi::xml_node a_TypesNo
         if (!count_element) {
             throw std::invalid_argument("Type " + name + " does not have a count element");
         }
-        int count = 0;
+        long long count = 0;
         pugi::xml_node fixed_element = count_element.child("fixed");
         if (fixed_element) {
-            count = fixed_element.text().as_int();
+            count = fixed_element.text().as_llong();
         } else {
             pugi::xml_node proportion_element = count_element.child("proportion");
             if (proportion_element) {
-                count = static_cast<int>(std::round(
-                        proportion_element.text().as_double() * static_cast<double>(a_GraphSize)));
+                count = std::llround(proportion_element.text().as_double() * static_cast<double>(a_GraphSize));
             } else {
                 throw std::invalid_argument("Type " + name + " does not have a fixed or proportion constraint");
             }
@@ -51,7 +51,7 @@ std::map<std::string, int> Schema::getConstraints(const pugi::xml_node a_TypesNo
         if (count <= 0) {
             throw std::invalid_argument("Error: type " + name + " is constrained to 0 nodes");
         }
-        constraints[name] = count;
+        constraints[name] = static_cast<uint64_t>(count);
     }
     return constraints;
 }
@@ -64,7 +64,7 @@ bool Schema::doSetsOverlap(const std::set<std::string> &a_TypeNames, const std::
 }
 
 void Schema::getTypes(std::map<std::string, std::vector<std::unique_ptr<Attribute>>> &a_Types,
-                      const pugi::xml_node a_TypesNode) {
+                      const pugi::xml_node a_TypesNode, ThreadPool &a_ThreadPool) {
     for (pugi::xml_node type : a_TypesNode.children("type")) {
         std::string name = type.attribute("name").as_string();
         if (name.empty()) {
@@ -73,11 +73,11 @@ void Schema::getTypes(std::map<std::string, std::vector<std::unique_ptr<Attribut
         if (a_Types.find(name) != a_Types.end()) {
             throw std::invalid_argument("Duplicate type found: " + name);
         }
-        a_Types.emplace(name, getAttributes(type.child("attributes")));
+        a_Types.emplace(name, getAttributes(type.child("attributes"), a_ThreadPool));
     }
 }
 
-long Schema::dateStringToEpoch(const std::string &a_DateString) {
+int64_t Schema::dateStringToEpoch(const std::string &a_DateString) {
     int year = 0;
     int month = 0;
     int day = 0;
@@ -98,21 +98,19 @@ long Schema::dateStringToEpoch(const std::string &a_DateString) {
     if (!success) {
         throw std::invalid_argument("Date does not follow the pattern 1988-11-23.");
     }
-    struct tm t = {0,0,0,0,0,0,0,0,0,0, nullptr};
-    t.tm_year = year - 1900;
-    t.tm_mon = month - 1;
-    t.tm_mday = day;
-    time_t timeSinceEpoch = mktime(&t);
-    if (timeSinceEpoch == -1) {
+    if (month < 1 || month > 12 || day < 1 ||
+        static_cast<unsigned int>(day) > getDaysInMonth(year, static_cast<unsigned int>(month))) {
         throw std::invalid_argument("Date is not a valid date.");
     }
-    return timeSinceEpoch;
+    // Midnight UTC, which DateAttribute formats back to the same date in any time zone.
+    constexpr int64_t seconds_per_day = 86400;
+    return daysFromCivil({year, static_cast<unsigned int>(month), static_cast<unsigned int>(day)}) * seconds_per_day;
 }
 
 std::vector<RelationDistribution> Schema::getDistributions(const pugi::xml_node a_TypesNode,
                                                            const std::set<std::string> &a_TypeNames,
                                                            const std::set<std::string> &a_PredicateNames,
-                                                           const std::map<std::string, int> &a_Constraints) {
+                                                           const std::map<std::string, uint64_t> &a_Constraints) {
     std::vector<RelationDistribution> distributions;
     for (pugi::xml_node type : a_TypesNode.children("type")) {
         std::string source = type.attribute("name").as_string();
@@ -150,8 +148,8 @@ std::vector<RelationDistribution> Schema::getDistributions(const pugi::xml_node
                 throw std::invalid_argument(
                         "Affinities can only be specified on relations between the same node types");
             }
-            int nr_source_nodes = a_Constraints.at(source);
-            int nr_target_nodes = a_Constraints.at(target);
+            uint64_t nr_source_nodes = a_Constraints.at(source);
+            uint64_t nr_target_nodes = a_Constraints.at(target);
             distributions.emplace_back(source, target, predicate, allow_loops, allow_parallel_edges,
                                        getDistribution(relation.child("inDistribution"), nr_target_nodes, true, false, false),
                                        getDistribution(relation.child("outDistribution"), nr_source_nodes, true, false, false),
@@ -190,21 +188,20 @@ double Schema::attributeAsDouble(pugi::xml_attribute a_Attribute, const bool a_I
         if (attrAsString.empty()) {
             return a_Default;
         }
-        return dateStringToEpoch(attrAsString);
+        return static_cast<double>(dateStringToEpoch(attrAsString));
     }
     return a_Attribute.as_double(a_Default);
 }
 
-int Schema::attributeAsInteger(pugi::xml_attribute a_Attribute, const bool a_IsDate) {
+int64_t Schema::attributeAsInteger(pugi::xml_attribute a_Attribute, const bool a_IsDate) {
     if (a_IsDate) {
-        // TODO(thom): this cast causes the 2038 problem. Fix it.
-        return static_cast<int>(dateStringToEpoch(a_Attribute.as_string()));
+        return dateStringToEpoch(a_Attribute.as_string());
     }
-    return a_Attribute.as_int();
+    return a_Attribute.as_llong();
 }
 
 std::unique_ptr<RandomDistribution> Schema::getDistribution(const pugi::xml_node a_DistributionNode,
-                                                            const int a_NrOfNodes,
+                                                            const uint64_t a_NrOfNodes,
                                                             const bool a_IntegerPrecision,
                                                             const bool a_IsDate,
                                                             const bool a_MustBeUnique) {
@@ -215,18 +212,28 @@ std::unique_ptr<RandomDistribution> Schema::getDistribution(const pugi::xml_node
         // We cannot use that trick for other distributions like the Gaussian distribution because even for node
         // degrees the mean may be a floating point number.
         if (a_IntegerPrecision) {
-            int min = attributeAsInteger(distribution.attribute("min"), a_IsDate);
+            int64_t min = attributeAsInteger(distribution.attribute("min"), a_IsDate);
             pugi::xml_attribute max_attribute = distribution.attribute("max");
             // If the user specified that the generated values must be unique and no max parameter is specified
             // for the uniform integer distribution, then we can simply use a counter starting from the minimum
-            // value as an optimization.
+            // value as an optimization. With a max parameter the range is permuted instead.
             if (!max_attribute && a_MustBeUnique) {
-                return std::make_unique<UniformIntegerUniqueDistribution>(min);
+                return std::make_unique<UniformIntegerUniqueDistribution>(min, std::numeric_limits<int64_t>::max(),
+                                                                          false);
             }
-            int max = attributeAsInteger(max_attribute, a_IsDate);
+            int64_t max = attributeAsInteger(max_attribute, a_IsDate);
             if (min > max) {
                 throw std::invalid_argument("Invalid uniform distribution; min > max");
             }
+            if (a_MustBeUnique) {
+                // The permutation is keyed by the number of values in the range, and 2^64 does not fit in an
+                // uint64_t.
+                if (min == std::numeric_limits<int64_t>::min() && max == std::numeric_limits<int64_t>::max()) {
+                    throw std::invalid_argument("Invalid unique uniform distribution; the range of min and max "
+                                                "cannot span all 64-bit integers");
+                }
+                return std::make_unique<UniformIntegerUniqueDistribution>(min, max, true);
+            }
             return std::make_unique<UniformIntegerDistribution>(min, max);
         }
 
@@ -303,7 +310,7 @@ std::unique_ptr<NumericAttribute> Schema::getNumericAttribute(const pugi::xml_no
         throw std::invalid_argument("Invalid precision attribute for numeric element");
     }
     // TODO(thom): Number argument for Zipfian should be configurable.
-    int number = 1000;
+    uint64_t number = 1000;
     if (a_IsDate) {
         return std::make_unique<DateAttribute>(a_Name, a_Required, a_Unique, min, max, precision,
                                                getDistribution(a_AttributeNode, number, 0 == precision, true, a_Unique));
@@ -312,12 +319,13 @@ std::unique_ptr<NumericAttribute> Schema::getNumericAttribute(const pugi::xml_no
                                               getDistribution(a_AttributeNode, number, 0 == precision, false, a_Unique));
 }
 
-std::vector<std::unique_ptr<Attribute>> Schema::getAttributes(const pugi::xml_node a_AttributesNode) {
+std::vector<std::unique_ptr<Attribute>> Schema::getAttributes(const pugi::xml_node a_AttributesNode,
+                                                              ThreadPool &a_ThreadPool) {
     std::vector<std::unique_ptr<Attribute>> attributes;
     for (pugi::xml_node attribute : a_AttributesNode.children()) {
         const std::string name = attribute.name();
         if (name == "attribute") {
-            attributes.emplace_back(parseAttributeNode(attribute));
+            attributes.emplace_back(parseAttributeNode(attribute, a_ThreadPool));
         } else {
             throw std::invalid_argument("Children of the attributes node must be attribute elements.");
         }
@@ -326,12 +334,12 @@ std::vector<std::unique_ptr<Attribute>> Schema::getAttributes(const pugi::xml_no
 }
 
 std::unique_ptr<Attribute> Schema::getChoiceAttribute(const pugi::xml_node a_ChoiceNode, const std::string &a_Name,
-                                                      bool a_Required, bool a_Unique) {
+                                                      bool a_Required, bool a_Unique, ThreadPool &a_ThreadPool) {
     std::vector<std::unique_ptr<Attribute>> attributes;
     std::vector<double> probabilities;
     double total_probability = 0;
     for (pugi::xml_node attribute_node : a_ChoiceNode.children()) {
-        attributes.emplace_back(getAttributeKind(attribute_node, a_Name, a_Required, a_Unique));
+        attributes.emplace_back(getAttributeKind(attribute_node, a_Name, a_Required, a_Unique, a_ThreadPool));
         pugi::xml_attribute probability_attr = attribute_node.attribute("probability");
         if (probability_attr) {
             double probability = probability_attr.as_double(-1.0);
@@ -351,36 +359,18 @@ std::unique_ptr<Attribute> Schema::getChoiceAttribute(const pugi::xml_node a_Cho
     }
     if (probabilities.empty() || total_probability <= std::numeric_limits<double>::epsilon()) {
         double uniform_probability = 1.0 / static_cast<double>(count);
-        probabilities.reserve(count);
-        for (size_t i = 0; i < count; ++i) {
-            probabilities[i] = uniform_probability;
-        }
+        probabilities.assign(count, uniform_probability);
         total_probability = 1.0;
     }
-    const double epsilon = std::numeric_limits<double>::epsilon() * static_cast<double>(count);
     const double deviation = std::abs(total_probability - 1.0);
     if (deviation > m_LenientCategoryProbabilityEpsilon) {
         throw std::invalid_argument("The probabilities of attribute choices need to sum (approximately) to 1");
     }
-    if (deviation > epsilon) {
-        // Normalize the probabilities.
-        for (auto& probability : probabilities) {
-            probability /= total_probability;
-        }
-        total_probability = 1.0;
-    }
-
-    std::map<double, std::unique_ptr<Attribute>> probabilitiesAttributes;
-    double cumulativeProbability = 0.0;
-    for (size_t i = 0; i < count; ++i) {
-        cumulativeProbability += probabilities[i];
-        probabilitiesAttributes[cumulativeProbability] = std::move(attributes[i]);
-    }
-
-    return std::make_unique<ChoiceAttribute>(a_Name, a_Required, a_Unique, std::move(probabilitiesAttributes), total_probability);
+    // The alias table normalizes the probabilities.
+    return std::make_unique<ChoiceAttribute>(a_Name, a_Required, a_Unique, std::move(attributes), probabilities);
 }
 
-std::unique_ptr<Attribute> Schema::parseAttributeNode(const pugi::xml_node a_AttributeNode) {
+std::unique_ptr<Attribute> Schema::parseAttributeNode(const pugi::xml_node a_AttributeNode, ThreadPool &a_ThreadPool) {
     std::string name = a_AttributeNode.attribute("name").as_string();
     if (name.empty()) {
         throw std::invalid_argument("Attribute name cannot be empty");
@@ -389,13 +379,13 @@ std::unique_ptr<Attribute> Schema::parseAttributeNode(const pugi::xml_node a_Att
     bool unique = a_AttributeNode.attribute("unique").as_bool();
     pugi::xml_node kind = a_AttributeNode.first_child();
     if (kind && !kind.next_sibling()) {
-        return getAttributeKind(kind, name, required, unique);
+        return getAttributeKind(kind, name, required, unique, a_ThreadPool);
     }
     throw std::invalid_argument("The attribute node must have a single child node.");
 }
 
 std::unique_ptr<Attribute> Schema::getAttributeKind(const pugi::xml_node a_AttributeKindNode, const std::string &a_Name,
-                                                    bool a_Required, bool a_Unique) {
+                                                    bool a_Required, bool a_Unique, ThreadPool &a_ThreadPool) {
     const std::string kind = a_AttributeKindNode.name();
     if (kind.empty()) {
         throw std::invalid_argument("Attribute kind node name cannot be empty");
@@ -407,8 +397,11 @@ std::unique_ptr<Attribute> Schema::getAttributeKind(const pugi::xml_node a_Attri
         return getNumericAttribute(a_AttributeKindNode, false, a_Name, a_Required, a_Unique);
     }
     if (kind == "categorical") {
-        std::map<std::string, double> categories = getCategories(a_AttributeKindNode);
-        return std::make_unique<CategoricalAttribute>(a_Name, a_Required, a_Unique, categories);
+        StringPool categories;
+        std::vector<double> probabilities;
+        getCategories(a_AttributeKindNode, categories, probabilities, a_ThreadPool);
+        return std::make_unique<CategoricalAttribute>(a_Name, a_Required, a_Unique, std::move(categories),
+                                                      probabilities);
     }
     if (kind == "regex") {
         std::string regex = a_AttributeKindNode.text().as_string();
@@ -418,64 +411,19 @@ std::unique_ptr<Attribute> Schema::getAttributeKind(const pugi::xml_node a_Attri
         return std::make_unique<RegexAttribute>(a_Name, a_Required, a_Unique, regex);
     }
     if (kind == "choice") {
-        return getChoiceAttribute(a_AttributeKindNode, a_Name, a_Required, a_Unique);
+        return getChoiceAttribute(a_AttributeKindNode, a_Name, a_Required, a_Unique, a_ThreadPool);
     }
     throw std::invalid_argument("Attribute must be numeric, categorical, regex, date or choice");
 }
 
-std::pair<std::map<std::string, double>, double> Schema::getCategoriesFromFile(const std::string& a_FileName) {
-    std::map<std::string, double> categories;
-    double total_probability = 0;
-    std::ifstream file(a_FileName);
-    if (!file.is_open()) {
-        throw std::invalid_argument("Cannot open category file.");
-    }
-    std::string line;
-    double probability = 0.0;
-    std::string name;
-    std::smatch match;
-    bool hasMatch;
-    while (std::getline(file, line)) {
-        if (!line.empty()) {
-            hasMatch = false;
-            if (std::regex_match(line, match, m_CSVParseRegex)) {
-                if (match.size() == 4) {
-                    if (match[1].matched) {
-                        name = match[1].str();
-                    } else {
-                        name = match[2].str();
-                    }
-                    try {
-                        probability = std::stod(match[3].str());
-                    } catch (std::logic_error&) {
-                        throw std::invalid_argument("Category probability must be a valid number.");
-                    }
-                    if (probability < 0.0 || probability > 1.0) {
-                        throw std::invalid_argument("Category probability must be in the range [0,1]");
-                    }
-                    total_probability += probability;
-                    hasMatch = true;
-                }
-            }
-            if (!hasMatch) {
-                if (total_probability > 0.0) {
-                    throw std::invalid_argument("Probability needs to be specified on all categories or none");
-                }
-                name = line;
-                probability = 0.0;
-            }
-            if (categories.find(name) != categories.end()) {
-                throw std::invalid_argument("Category defined multiple times");
-            }
-            categories[name] = probability;
-        }
-    }
-    file.close();
-    return make_pair(categories, total_probability);
+double Schema::getCategoriesFromFile(const std::string &a_FileName, StringPool &a_Categories,
+                                     std::vector<double> &a_Probabilities, ThreadPool &a_ThreadPool) {
+    const CategoryFile file(a_FileName);
+    return file.readCategories(a_ThreadPool, a_Categories, a_Probabilities);
 }
 
-std::pair<std::map<std::string, double>, double> Schema::getCategoriesFromSchema(const pugi::xml_object_range<pugi::xml_named_node_iterator> a_CategoriesIterator) {
-    std::map<std::string, double> categories;
+double Schema::getCategoriesFromSchema(const pugi::xml_object_range<pugi::xml_named_node_iterator> a_CategoriesIterator,
+                                       StringPool &a_Categories, std::vector<double> &a_Probabilities) {
     double total_probability = 0;
     for (pugi::xml_node category : a_CategoriesIterator) {
         double probability = 0.0;
@@ -493,16 +441,16 @@ std::pair<std::map<std::string, double>, double> Schema::getCategoriesFromSchema
         } else if (total_probability > 0.0) {
             throw std::invalid_argument("Probability needs to be specified on all categories or none");
         }
-        if (categories.find(name) != categories.end()) {
+        if (a_Categories.intern(name) != a_Probabilities.size()) {
             throw std::invalid_argument("Category defined multiple times");
         }
-        categories[name] = probability;
+        a_Probabilities.push_back(probability);
     }
-    return make_pair(categories, total_probability);
+    return total_probability;
 }
 
-std::map<std::string, double> Schema::getCategories(const pugi::xml_node a_categoriesNode) {
-    std::map<std::string, double> categories;
+void Schema::getCategories(const pugi::xml_node a_categoriesNode, StringPool &a_Categories,
+                           std::vector<double> &a_Probabilities, ThreadPool &a_ThreadPool) {
     double total_probability = 0;
     pugi::xml_attribute file_attr = a_categoriesNode.attribute("file");
     const auto& categoriesIterator = a_categoriesNode.children("category");
@@ -514,37 +462,23 @@ std::map<std::string, double> Schema::getCategories(const pugi::xml_node a_categ
         if (fileName.empty()) {
             throw std::invalid_argument("Category file name cannot be empty.");
         }
-        auto category_pair = getCategoriesFromFile(fileName);
-        categories = category_pair.first;
-        total_probability = category_pair.second;
+        total_probability = getCategoriesFromFile(fileName, a_Categories, a_Probabilities, a_ThreadPool);
     } else {
-        auto category_pair = getCategoriesFromSchema(categoriesIterator);
-        categories = category_pair.first;
-        total_probability = category_pair.second;
+        total_probability = getCategoriesFromSchema(categoriesIterator, a_Categories, a_Probabilities);
     }
-    auto count = categories.size();
+    auto count = a_Probabilities.size();
     if (count == 0) {
         throw std::invalid_argument("No categories are defined in the category element or file.");
     }
     if (total_probability <= std::numeric_limits<double>::epsilon()) {
-        double uniform_probability = 1.0 / static_cast<double>(count);
-        for (auto &category : categories) {
-            category.second = uniform_probability;
-        }
+        a_Probabilities.assign(count, 1.0 / static_cast<double>(count));
         total_probability = 1.0;
     }
-    const double epsilon = std::numeric_limits<double>::epsilon() * static_cast<double>(count);
     const double deviation = std::abs(total_probability - 1.0);
     if (deviation > m_LenientCategoryProbabilityEpsilon) {
         throw std::invalid_argument("The probabilities of categories need to sum (approximately) to 1");
     }
-    if (deviation > epsilon) {
-        // Normalize the probabilities.
-        for (auto &[key, value] : categories) {
-            value /= total_probability;
-        }
-    }
-    return categories;
+    // The alias table normalizes the probabilities.
 }
 
 std::set<std::string>
@@ -6,66 +6,79 @@
 #include "random_distribution.h"
 #include "attribute.h"
 #include "affinity.h"
+#include "thread_pool.h"
 #include <set>
 
 class Schema {
 private:
     std::set<std::string> m_Predicates;
     std::map<std::string, std::vector<std::unique_ptr<Attribute>>> m_Types;
-    std::map<std::string, int> m_Constraints;
+    std::map<std::string, uint64_t> m_Constraints;
     std::vector<RelationDistribution> m_RelationDistributions;
     static const std::regex m_DateRegex;
-    static const std::regex m_CSVParseRegex;
     static const double m_LenientCategoryProbabilityEpsilon;
 
     static void getTypes(std::map<std::string, std::vector<std::unique_ptr<Attribute>>> &a_Types,
-                         const pugi::xml_node a_TypesNode);
+                         const pugi::xml_node a_TypesNode, ThreadPool &a_ThreadPool);
 
     static std::unique_ptr<NumericAttribute> getNumericAttribute(const pugi::xml_node a_AttributeNode,
                                                                  const bool a_IsDate, const std::string& a_Name,
                                                                  const bool a_Required, const bool a_Unique);
 
-    static std::vector<std::unique_ptr<Attribute>> getAttributes(const pugi::xml_node a_AttributesNode);
+    static std::vector<std::unique_ptr<Attribute>> getAttributes(const pugi::xml_node a_AttributesNode,
+                                                                 ThreadPool &a_ThreadPool);
 
-    static std::unique_ptr<Attribute> getChoiceAttribute(const pugi::xml_node a_ChoiceNode, const std::string &a_Name, bool a_Required, bool a_Unique);
+    static std::unique_ptr<Attribute> getChoiceAttribute(const pugi::xml_node a_ChoiceNode, const std::string &a_Name,
+                                                         bool a_Required, bool a_Unique, ThreadPool &a_ThreadPool);
 
-    static std::unique_ptr<Attribute> parseAttributeNode(const pugi::xml_node a_AttributeNode);
+    static std::unique_ptr<Attribute> parseAttributeNode(const pugi::xml_node a_AttributeNode,
+                                                         ThreadPool &a_ThreadPool);
 
     static std::unique_ptr<Attribute> getAttributeKind(const pugi::xml_node a_AttributeKindNode,
-                                                       const std::string &a_Name, bool a_Required, bool a_Unique);
+                                                       const std::string &a_Name, bool a_Required, bool a_Unique,
+                                                       ThreadPool &a_ThreadPool);
 
     static std::set<std::string>
     getUniqueNodeNames(const pugi::xml_node a_TypesNode, const std::string &a_ElementName);
 
     static bool doSetsOverlap(const std::set<std::string> &a_TypeNames, const std::set<std::string> &a_PredicateNames);
 
-    static std::map<std::string, int> getConstraints(const pugi::xml_node a_TypesNode, const int a_GraphSize);
+    static std::map<std::string, uint64_t> getConstraints(const pugi::xml_node a_TypesNode,
+                                                          const uint64_t a_GraphSize);
 
-    static std::map<std::string, double> getCategories(const pugi::xml_node a_categoriesNode);
+    // Adds the categories and their probabilities, in the order they are defined in. Category files are read with
+    // the threads of a_ThreadPool.
+    static void getCategories(const pugi::xml_node a_categoriesNode, StringPool &a_Categories,
+                              std::vector<double> &a_Probabilities, ThreadPool &a_ThreadPool);
 
-    static std::pair<std::map<std::string, double>, double> getCategoriesFromFile(const std::string& a_FileName);
+    // These return the sum of the probabilities, which are 0 for categories without one.
+    static double getCategoriesFromFile(const std::string &a_FileName, StringPool &a_Categories,
+                                        std::vector<double> &a_Probabilities, ThreadPool &a_ThreadPool);
 
-    static std::pair<std::map<std::string, double>, double> getCategoriesFromSchema(pugi::xml_object_range<pugi::xml_named_node_iterator> a_CategoriesIterator);
+    static double getCategoriesFromSchema(pugi::xml_object_range<pugi::xml_named_node_iterator> a_CategoriesIterator,
+                                          StringPool &a_Categories, std::vector<double> &a_Probabilities);
 
     static std::vector<RelationDistribution> getDistributions(const pugi::xml_node a_TypesNode,
                                                               const std::set<std::string> &a_TypeNames,
                                                               const std::set<std::string> &a_PredicateNames,
-                                                              const std::map<std::string, int> &a_Constraints);
+                                                              const std::map<std::string, uint64_t> &a_Constraints);
 
     static std::unique_ptr<RandomDistribution> getDistribution(const pugi::xml_node a_DistributionNode,
-                                                               const int a_NrOfNodes,
+                                                               const uint64_t a_NrOfNodes,
                                                                const bool a_IntegerPrecision,
                                                                const bool a_IsDate,
                                                                const bool a_MustBeUnique);
 
     static std::map<std::string, Affinity> getAffinities(const pugi::xml_node a_AffinitiesNode);
 
-    static long dateStringToEpoch(const std::string &a_DateString);
+    // Seconds since 1970-01-01 UTC.
+    static int64_t dateStringToEpoch(const std::string &a_DateString);
     static double attributeAsDouble(pugi::xml_attribute a_Attribute, const bool a_IsDate, const double a_Default = 0.0);
-    static int attributeAsInteger(pugi::xml_attribute a_Attribute, const bool a_IsDate);
+    static int64_t attributeAsInteger(pugi::xml_attribute a_Attribute, const bool a_IsDate);
 
 public:
-    Schema(const pugi::xml_node a_TypesNode, const pugi::xml_node a_PredicatesNode, const int a_GraphSize);
+    Schema(const pugi::xml_node a_TypesNode, const pugi::xml_node a_PredicatesNode, const uint64_t a_GraphSize,
+           ThreadPool &a_ThreadPool);
 
     Schema(const Schema &) = delete; // No copying.
     Schema &operator=(const Schema &) = delete; // No copying.
@@ -74,7 +87,7 @@ public:
         return m_RelationDistributions;
     }
 
-    const std::map<std::string, int> &getConstraints() const {
+    const std::map<std::string, uint64_t> &getConstraints() const {
         return m_Constraints;
     }
 
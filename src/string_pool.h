@@ -0,0 +1,95 @@
+#ifndef GMARK_STRING_POOL_H
+#define GMARK_STRING_POOL_H
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Strings stored back to back in one buffer and identified by their index. Equal strings are stored once. The bytes
+// of a string are kept exactly as they are written to the output, so appending one is a single copy. The strings are
+// found again with an open addressing table of indices into the buffer, so a pool of millions of strings holds every
+// byte once and does not allocate per string.
+class StringPool {
+private:
+    std::string m_Data;
+    std::vector<size_t> m_Ends;
+    // Index + 1 of the string in every slot, or 0 for an empty slot. Probed linearly.
+    std::vector<uint32_t> m_Slots;
+    size_t m_Mask = 0;
+
+    static size_t getHash(const std::string_view a_String) {
+        return std::hash<std::string_view>()(a_String);
+    }
+
+    std::string_view getString(const uint32_t a_Index) const {
+        return {getData(a_Index), getLength(a_Index)};
+    }
+
+    // Keeps the table at most half full.
+    void growSlots(const size_t a_NrOfStrings) {
+        size_t nr_slots = 16;
+        while (nr_slots < 2 * a_NrOfStrings) {
+            nr_slots *= 2;
+        }
+        if (nr_slots <= m_Slots.size()) {
+            return;
+        }
+        m_Slots.assign(nr_slots, 0);
+        m_Mask = nr_slots - 1;
+        for (uint32_t index = 0; index < m_Ends.size(); ++index) {
+            size_t slot = getHash(getString(index)) & m_Mask;
+            while (m_Slots[slot] != 0) {
+                slot = (slot + 1) & m_Mask;
+            }
+            m_Slots[slot] = index + 1;
+        }
+    }
+
+public:
+    // Makes room for a_NrOfStrings strings of a_NrOfBytes bytes in total.
+    void reserve(const size_t a_NrOfStrings, const size_t a_NrOfBytes) {
+        m_Data.reserve(a_NrOfBytes);
+        m_Ends.reserve(a_NrOfStrings);
+        growSlots(a_NrOfStrings);
+    }
+
+    // Returns the index of a_String, which is added to the pool when it is not in it yet. A new string gets the
+    // index size() had before the call.
+    uint32_t intern(const std::string_view a_String) {
+        if (2 * (m_Ends.size() + 1) > m_Slots.size()) {
+            growSlots(m_Ends.size() + 1);
+        }
+        size_t slot = getHash(a_String) & m_Mask;
+        while (m_Slots[slot] != 0) {
+            if (getString(m_Slots[slot] - 1) == a_String) {
+                return m_Slots[slot] - 1;
+            }
+            slot = (slot + 1) & m_Mask;
+        }
+        if (m_Ends.size() >= UINT32_MAX - 1) {
+            throw std::invalid_argument("A string pool holds fewer than 2^32 - 1 strings.");
+        }
+        const auto index = static_cast<uint32_t>(m_Ends.size());
+        m_Data.append(a_String.data(), a_String.size());
+        m_Ends.push_back(m_Data.size());
+        m_Slots[slot] = index + 1;
+        return index;
+    }
+
+    size_t size() const {
+        return m_Ends.size();
+    }
+
+    const char *getData(const uint32_t a_Index) const {
+        return m_Data.data() + (a_Index == 0 ? 0 : m_Ends[a_Index - 1]);
+    }
+
+    size_t getLength(const uint32_t a_Index) const {
+        return m_Ends[a_Index] - (a_Index == 0 ? 0 : m_Ends[a_Index - 1]);
+    }
+};
+
+#endif //GMARK_STRING_POOL_H
@@ -0,0 +1,90 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(const unsigned int a_NrOfThreads)
+        : m_NrOfThreads(std::max(1U, a_NrOfThreads)) {
+    m_Workers.reserve(m_NrOfThreads - 1);
+    for (unsigned int i = 1; i < m_NrOfThreads; ++i) {
+        m_Workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_WorkAvailable.notify_all();
+    for (auto &worker : m_Workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(const size_t a_Count, const std::function<void(size_t)> &a_Function) {
+    if (m_Workers.empty() || a_Count <= 1) {
+        for (size_t i = 0; i < a_Count; ++i) {
+            a_Function(i);
+        }
+        return;
+    }
+    auto group = std::make_shared<TaskGroup>(a_Function, a_Count);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Groups.push_back(group);
+    }
+    m_WorkAvailable.notify_all();
+    while (runNextIndex(*group)) {}
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_GroupFinished.wait(lock, [&group] { return group->m_Completed == group->m_Count; });
+    if (group->m_Exception) {
+        std::rethrow_exception(group->m_Exception);
+    }
+}
+
+bool ThreadPool::runNextIndex(TaskGroup &a_Group) {
+    const size_t index = a_Group.m_NextIndex.fetch_add(1);
+    if (index >= a_Group.m_Count) {
+        return false;
+    }
+    if (index + 1 == a_Group.m_Count) {
+        // Every index has been claimed, so idle workers should no longer look at this group.
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Groups.erase(std::remove_if(m_Groups.begin(), m_Groups.end(),
+                                      [&a_Group](const auto &a_Other) { return a_Other.get() == &a_Group; }),
+                       m_Groups.end());
+    }
+    std::exception_ptr exception;
+    try {
+        a_Group.m_Function(index);
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (exception && !a_Group.m_Exception) {
+            a_Group.m_Exception = exception;
+        }
+        finished = ++a_Group.m_Completed == a_Group.m_Count;
+    }
+    if (finished) {
+        m_GroupFinished.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::shared_ptr<TaskGroup> group;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkAvailable.wait(lock, [this] { return m_Stopping || !m_Groups.empty(); });
+            if (m_Groups.empty()) {
+                return;
+            }
+            // Prefer the most recent group, which is the innermost one when parallelFor calls are nested.
+            group = m_Groups.back();
+        }
+        while (runNextIndex(*group)) {}
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef GMARK_THREAD_POOL_H
+#define GMARK_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+private:
+    // A single parallelFor invocation. Indices are claimed by the calling thread and by idle workers alike.
+    struct TaskGroup {
+        const std::function<void(size_t)> &m_Function;
+        const size_t m_Count;
+        std::atomic<size_t> m_NextIndex{0};
+        size_t m_Completed = 0;
+        std::exception_ptr m_Exception;
+
+        TaskGroup(const std::function<void(size_t)> &a_Function, const size_t a_Count)
+                : m_Function(a_Function), m_Count(a_Count) {}
+    };
+
+    const unsigned int m_NrOfThreads;
+    std::vector<std::thread> m_Workers;
+    std::deque<std::shared_ptr<TaskGroup>> m_Groups;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkAvailable;
+    std::condition_variable m_GroupFinished;
+    bool m_Stopping = false;
+
+    void workerLoop();
+
+    bool runNextIndex(TaskGroup &a_Group);
+
+public:
+    ThreadPool(const ThreadPool &) = delete; // no copy operations.
+    ThreadPool &operator=(const ThreadPool &) = delete; // no copy operations.
+    ThreadPool(ThreadPool &&) = delete; // no move operations.
+    ThreadPool &operator=(ThreadPool &&) = delete; // no move operations.
+
+    // The calling thread counts as one of the threads, so a pool of one thread spawns no workers.
+    explicit ThreadPool(const unsigned int a_NrOfThreads);
+
+    ~ThreadPool();
+
+    unsigned int getNrOfThreads() const {
+        return m_NrOfThreads;
+    }
+
+    // Calls a_Function for every index in [0, a_Count) and returns once all calls have finished. The calling
+    // thread takes part in the work, which makes it safe to call parallelFor from within a task. The first
+    // exception thrown by a task is rethrown here.
+    void parallelFor(const size_t a_Count, const std::function<void(size_t)> &a_Function);
+};
+
+#endif //GMARK_THREAD_POOL_H
@@ -0,0 +1,60 @@
+#include "unique_value_set.h"
+#include <cmath>
+#include "random_stream.h"
+
+const unsigned int UniqueValueSet::m_ShardBits = 6;
+
+UniqueValueSet::UniqueValueSet(const uint64_t a_ExpectedSize) : m_Shards(getNrOfShards()) {
+    const size_t nr_values = getNrOfValuesPerShard(a_ExpectedSize);
+    for (auto &shard : m_Shards) {
+        reserve(shard, nr_values);
+    }
+}
+
+size_t UniqueValueSet::getNrOfSlots(const size_t a_NrOfValues) {
+    size_t nr_slots = 16;
+    while (3 * nr_slots < 4 * a_NrOfValues) {
+        nr_slots *= 2;
+    }
+    return nr_slots;
+}
+
+size_t UniqueValueSet::getNrOfValuesPerShard(const uint64_t a_ExpectedSize) {
+    // The number of values per shard is binomial, so leave room for a few standard deviations above the mean.
+    const double per_shard = static_cast<double>(a_ExpectedSize) / static_cast<double>(getNrOfShards());
+    return static_cast<size_t>(per_shard + 4.0 * std::sqrt(per_shard));
+}
+
+void UniqueValueSet::reserve(Shard &a_Shard, const size_t a_NrOfValues) {
+    const size_t nr_slots = getNrOfSlots(a_NrOfValues);
+    if (nr_slots <= a_Shard.m_Slots.size()) {
+        return;
+    }
+    std::vector<uint64_t> slots(nr_slots, 0);
+    const size_t mask = nr_slots - 1;
+    for (const uint64_t fingerprint : a_Shard.m_Slots) {
+        if (fingerprint != 0) {
+            size_t slot = static_cast<size_t>(fingerprint) & mask;
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = fingerprint;
+        }
+    }
+    a_Shard.m_Slots = std::move(slots);
+    a_Shard.m_Mask = mask;
+}
+
+uint64_t UniqueValueSet::getFingerprint(const std::string_view a_Value) {
+    // FNV-1a alone mixes the last bytes of a value poorly into the high bits, which pick the shard.
+    return RandomStream::mix64(RandomStream::hashString(a_Value));
+}
+
+size_t UniqueValueSet::getNrOfShards() {
+    return static_cast<size_t>(1) << m_ShardBits;
+}
+
+double UniqueValueSet::getExpectedBytes(const uint64_t a_NrOfValues) {
+    const size_t nr_slots = getNrOfSlots(getNrOfValuesPerShard(a_NrOfValues));
+    return static_cast<double>(getNrOfShards()) * static_cast<double>(nr_slots) * sizeof(uint64_t);
+}
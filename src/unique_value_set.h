@@ -0,0 +1,81 @@
+#ifndef GMARK_UNIQUE_VALUE_SET_H
+#define GMARK_UNIQUE_VALUE_SET_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// The values that a unique attribute has taken so far, stored as 64-bit fingerprints in open addressing tables with
+// linear probing. Equal values have equal fingerprints, so a repeated value is always found. Two different values
+// share a fingerprint with a probability of about 2^-64 per pair, in which case the later one is redrawn as well,
+// which costs a draw but never lets a duplicate through. A value takes 8 bytes in a table that is between 3/8 and
+// 3/4 full, so about 11 to 21 bytes per value, without the per-node allocations and the copies of the values that
+// a std::unordered_set<std::string> would hold.
+//
+// The set is split into shards by the high bits of the fingerprints. A shard is not locked, so calls for different
+// shards may run concurrently, but calls for the same shard may not. Giving every shard to one task that visits its
+// values in node order makes the outcome independent of the number of threads.
+class UniqueValueSet {
+private:
+    struct Shard {
+        // 0 marks an empty slot, so a fingerprint of 0 is stored as 1.
+        std::vector<uint64_t> m_Slots;
+        size_t m_Mask = 0;
+        size_t m_Size = 0;
+    };
+
+    static const unsigned int m_ShardBits;
+
+    std::vector<Shard> m_Shards;
+
+    // The number of slots of a table for a_NrOfValues values, which is at most 3/4 full.
+    static size_t getNrOfSlots(const size_t a_NrOfValues);
+
+    static size_t getNrOfValuesPerShard(const uint64_t a_ExpectedSize);
+
+    // Sizes a_Shard for a_NrOfValues values. The slot of a fingerprint comes from its low bits, which are
+    // independent of the high bits that pick the shard.
+    static void reserve(Shard &a_Shard, const size_t a_NrOfValues);
+
+public:
+    UniqueValueSet(const UniqueValueSet &) = delete; // no copy operations.
+    UniqueValueSet &operator=(const UniqueValueSet &) = delete; // no copy operations.
+
+    // Sizes the shards for a_ExpectedSize values, so that the tables only grow when more values are inserted.
+    explicit UniqueValueSet(const uint64_t a_ExpectedSize);
+
+    // The fingerprints are the same on every platform, so the values that are redrawn only depend on the seed.
+    static uint64_t getFingerprint(const std::string_view a_Value);
+
+    static size_t getNrOfShards();
+
+    static size_t getShard(const uint64_t a_Fingerprint) {
+        return static_cast<size_t>(a_Fingerprint >> (64U - m_ShardBits));
+    }
+
+    // The memory of a set that is sized for a_NrOfValues values.
+    static double getExpectedBytes(const uint64_t a_NrOfValues);
+
+    // Returns false when a value with this fingerprint was already inserted.
+    bool insert(uint64_t a_Fingerprint) {
+        if (a_Fingerprint == 0) {
+            a_Fingerprint = 1;
+        }
+        Shard &shard = m_Shards[getShard(a_Fingerprint)];
+        if (4 * (shard.m_Size + 1) > 3 * shard.m_Slots.size()) {
+            reserve(shard, 2 * (shard.m_Size + 1));
+        }
+        size_t slot = static_cast<size_t>(a_Fingerprint) & shard.m_Mask;
+        while (shard.m_Slots[slot] != 0) {
+            if (shard.m_Slots[slot] == a_Fingerprint) {
+                return false;
+            }
+            slot = (slot + 1) & shard.m_Mask;
+        }
+        shard.m_Slots[slot] = a_Fingerprint;
+        ++shard.m_Size;
+        return true;
+    }
+};
+
+#endif //GMARK_UNIQUE_VALUE_SET_H